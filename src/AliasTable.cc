@@ -0,0 +1,70 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#include "AliasTable.h"
+
+AliasTable::AliasTable(const std::vector<double>& weights) {
+
+    int n = weights.size();
+    double sum = 0;
+
+    for (int i = 0; i < n; i++)
+        sum += weights[i];
+
+    columns.resize(n);
+
+    // Scaled probabilities: a column is "small" if it is below the mean ( 1 ), "large" otherwise.
+    std::vector<double> scaled(n);
+    std::vector<int> small, large;
+
+    for (int i = 0; i < n; i++) {
+
+        scaled[i] = weights[i] * n / sum;
+
+        if (scaled[i] < 1)
+            small.push_back(i);
+        else
+            large.push_back(i);
+    }
+
+    // Every small column is filled up by a large one, which gives away the same amount.
+    while (!small.empty() && !large.empty()) {
+
+        int s = small.back();
+        int l = large.back();
+        small.pop_back();
+
+        columns[s].keep = scaled[s];
+        columns[s].alias = l;
+
+        scaled[l] -= 1 - scaled[s];
+
+        if (scaled[l] < 1) {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+
+    // What is left is full, up to the rounding errors.
+    for (size_t i = 0; i < large.size(); i++) {
+        columns[large[i]].keep = 1;
+        columns[large[i]].alias = large[i];
+    }
+
+    for (size_t i = 0; i < small.size(); i++) {
+        columns[small[i]].keep = 1;
+        columns[small[i]].alias = small[i];
+    }
+}
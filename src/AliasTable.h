@@ -0,0 +1,51 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#ifndef __SRAWN_ALIASTABLE_H_
+#define __SRAWN_ALIASTABLE_H_
+
+#include <stddef.h>
+#include <vector>
+
+/**
+ * Alias table ( Walker, Vose ) of a discrete distribution on 0 .. n-1: a draw costs one uniform
+ * number, one multiplication and one comparison, whatever n and the weights are.
+ * The column u*n is kept with probability "keep", otherwise its alias is returned.
+ */
+class AliasTable
+{
+private:
+    struct Column {
+        double keep;
+        int alias;
+    };
+
+    std::vector<Column> columns;
+
+public:
+    // The weights must be non-negative with a positive sum: they do not need to be normalized.
+    explicit AliasTable(const std::vector<double>& weights);
+
+    int size() const { return columns.size(); }
+
+    // Outcome of the uniform number u in [0,1).
+    int sample(double u) const {
+        double x = u * columns.size();
+        int column = (int) x;
+        return (x - column < columns[column].keep) ? column : columns[column].alias;
+    }
+};
+
+#endif
@@ -0,0 +1,177 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#include "ArrivalTrace.h"
+
+#include <string.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define TRACE_HEADER_SIZE 12
+
+/* WRITER */
+
+ArrivalTraceWriter::ArrivalTraceWriter() {
+
+    file = 0;
+    last_time = 0;
+}
+
+ArrivalTraceWriter::~ArrivalTraceWriter() {
+
+    close();
+}
+
+bool ArrivalTraceWriter::open(const char *path) {
+
+    close();
+
+    file = fopen(path, "wb");
+    if (file == 0)
+        return false;
+
+    // Large buffer: arrivals are appended one varint at a time.
+    setvbuf(file, 0, _IOFBF, 1 << 20);
+
+    int32_t header[2] = { ARRIVAL_TRACE_VERSION, ARRIVAL_TRACE_UNIT_EXPONENT };
+    fwrite(ARRIVAL_TRACE_MAGIC, 1, 4, file);
+    fwrite(header, sizeof(int32_t), 2, file);
+
+    last_time = 0;
+
+    return true;
+}
+
+void ArrivalTraceWriter::append(double time) {
+
+    uint64_t now = (uint64_t) llround(time * pow(10, -ARRIVAL_TRACE_UNIT_EXPONENT));
+    uint64_t delta = now - last_time;
+    last_time = now;
+
+    // Unsigned LEB128: 7 bits per byte, the high bit means "more bytes follow".
+    uint8_t buffer[10];
+    int n = 0;
+
+    do {
+        uint8_t byte = delta & 0x7f;
+        delta >>= 7;
+        buffer[n++] = (delta != 0) ? (byte | 0x80) : byte;
+    } while (delta != 0);
+
+    fwrite(buffer, 1, n, file);
+}
+
+void ArrivalTraceWriter::close() {
+
+    if (file != 0)
+        fclose(file);
+
+    file = 0;
+}
+
+/* READER */
+
+ArrivalTraceReader::ArrivalTraceReader() {
+
+    begin = cursor = end = 0;
+    length = 0;
+    unit = 0;
+    corrupted = false;
+}
+
+ArrivalTraceReader::~ArrivalTraceReader() {
+
+    close();
+}
+
+bool ArrivalTraceReader::open(const char *path) {
+
+    close();
+
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < TRACE_HEADER_SIZE) {
+        ::close(fd);
+        return false;
+    }
+
+    void *map = mmap(0, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+
+    if (map == MAP_FAILED)
+        return false;
+
+    // The trace is read only once, from the beginning to the end.
+    madvise(map, info.st_size, MADV_SEQUENTIAL);
+
+    begin = (const uint8_t*) map;
+    length = info.st_size;
+    end = begin + length;
+
+    int32_t header[2];
+    memcpy(header, begin + 4, sizeof(header));
+
+    if (memcmp(begin, ARRIVAL_TRACE_MAGIC, 4) != 0 || header[0] != ARRIVAL_TRACE_VERSION) {
+        close();
+        return false;
+    }
+
+    unit = pow(10, header[1]);
+    cursor = begin + TRACE_HEADER_SIZE;
+
+    return true;
+}
+
+bool ArrivalTraceReader::next(double& interarrival) {
+
+    uint64_t delta = 0;
+    int shift = 0;
+
+    while (cursor < end && shift < 64) {
+
+        uint8_t byte = *cursor++;
+        delta |= (uint64_t) (byte & 0x7f) << shift;
+        shift += 7;
+
+        if ((byte & 0x80) == 0) {
+            interarrival = delta * unit;
+            return true;
+        }
+    }
+
+    // A varint longer than 64 bits, or cut by the end of the file.
+    if (shift > 0) {
+        corrupted = true;
+        cursor = end;
+    }
+
+    return false;
+}
+
+void ArrivalTraceReader::close() {
+
+    if (begin != 0)
+        munmap((void*) begin, length);
+
+    begin = cursor = end = 0;
+    length = 0;
+    corrupted = false;
+}
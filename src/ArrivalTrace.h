@@ -0,0 +1,73 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#ifndef __SRAWN_ARRIVALTRACE_H_
+#define __SRAWN_ARRIVALTRACE_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * Binary arrival trace.
+ *
+ * Header: the 4 bytes "SRAT", then the version and the time unit exponent (int32 each, little endian).
+ * Body:   one unsigned LEB128 varint for each arrival: the interarrival-time in time units,
+ *         the first one measured from time 0.
+ */
+
+#define ARRIVAL_TRACE_MAGIC "SRAT"
+#define ARRIVAL_TRACE_VERSION 1
+#define ARRIVAL_TRACE_UNIT_EXPONENT (-9)       //  Nanoseconds
+
+class ArrivalTraceWriter
+{
+private:
+    FILE *file;
+    uint64_t last_time;                 //  Last recorded arrival [ time units ]
+
+public:
+    ArrivalTraceWriter();
+    ~ArrivalTraceWriter();
+
+    bool open(const char *path);
+    void append(double time);           //  Absolute arrival time [ s ]
+    void close();
+};
+
+/**
+ * The trace is memory-mapped and decoded sequentially: it is never loaded in memory as a whole.
+ */
+class ArrivalTraceReader
+{
+private:
+    const uint8_t *begin;
+    const uint8_t *cursor;
+    const uint8_t *end;
+    size_t length;
+    double unit;                        //  Duration of one time unit [ s ]
+    bool corrupted;
+
+public:
+    ArrivalTraceReader();
+    ~ArrivalTraceReader();
+
+    bool open(const char *path);
+    bool next(double& interarrival);    //  false when the trace is over or corrupted
+    bool isCorrupted() const { return corrupted; }
+    void close();
+};
+
+#endif
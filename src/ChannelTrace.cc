@@ -0,0 +1,232 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#include "ChannelTrace.h"
+
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define TRACE_HEADER_SIZE 12
+
+/* WRITER */
+
+ChannelTraceWriter::ChannelTraceWriter() {
+
+    file = 0;
+    channel_size = 0;
+    run_length = 0;
+}
+
+ChannelTraceWriter::~ChannelTraceWriter() {
+
+    close();
+}
+
+bool ChannelTraceWriter::open(const char *path, int channel_size) {
+
+    close();
+
+    file = fopen(path, "wb");
+    if (file == 0)
+        return false;
+
+    setvbuf(file, 0, _IOFBF, 1 << 20);
+
+    int32_t header[2] = { CHANNEL_TRACE_VERSION, channel_size };
+    fwrite(CHANNEL_TRACE_MAGIC, 1, 4, file);
+    fwrite(header, sizeof(int32_t), 2, file);
+
+    this->channel_size = channel_size;
+    current.assign((channel_size + 3) / 4, 0);
+    slot.assign((channel_size + 3) / 4, 0);
+    run_length = 0;
+
+    return true;
+}
+
+void ChannelTraceWriter::recordSlot(const int *attempts) {
+
+    for (size_t i = 0; i < slot.size(); i++)
+        slot[i] = 0;
+
+    for (int j = 0; j < channel_size; j++) {
+
+        int state = CHANNEL_IDLE;
+        if (attempts[j] == 1)
+            state = CHANNEL_SUCCESS;
+        else if (attempts[j] > 1)
+            state = CHANNEL_COLLISION;
+
+        slot[j >> 2] |= state << ((j & 3) * 2);
+    }
+
+    // Same states of the previous slot: the run goes on.
+    if (run_length > 0 && slot == current) {
+        run_length++;
+        return;
+    }
+
+    flushRun();
+    current.swap(slot);
+    run_length = 1;
+}
+
+void ChannelTraceWriter::recordIdleSlots(uint64_t count) {
+
+    // Idle is 0 in every 2-bit field.
+    for (size_t i = 0; i < slot.size(); i++)
+        slot[i] = 0;
+
+    if (run_length > 0 && slot == current) {
+        run_length += count;
+        return;
+    }
+
+    flushRun();
+    current.swap(slot);
+    run_length = count;
+}
+
+void ChannelTraceWriter::flushRun() {
+
+    if (run_length == 0)
+        return;
+
+    uint8_t buffer[10];
+    uint64_t value = run_length;
+    int n = 0;
+
+    do {
+        uint8_t byte = value & 0x7f;
+        value >>= 7;
+        buffer[n++] = (value != 0) ? (byte | 0x80) : byte;
+    } while (value != 0);
+
+    fwrite(buffer, 1, n, file);
+    fwrite(&current[0], 1, current.size(), file);
+
+    run_length = 0;
+}
+
+void ChannelTraceWriter::close() {
+
+    if (file != 0) {
+        flushRun();
+        fclose(file);
+    }
+
+    file = 0;
+}
+
+/* READER */
+
+ChannelTraceReader::ChannelTraceReader() {
+
+    begin = cursor = end = 0;
+    length = 0;
+    channel_size = 0;
+    corrupted = false;
+}
+
+ChannelTraceReader::~ChannelTraceReader() {
+
+    close();
+}
+
+bool ChannelTraceReader::open(const char *path) {
+
+    close();
+
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < TRACE_HEADER_SIZE) {
+        ::close(fd);
+        return false;
+    }
+
+    void *map = mmap(0, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+
+    if (map == MAP_FAILED)
+        return false;
+
+    madvise(map, info.st_size, MADV_SEQUENTIAL);
+
+    begin = (const uint8_t*) map;
+    length = info.st_size;
+    end = begin + length;
+
+    int32_t header[2];
+    memcpy(header, begin + 4, sizeof(header));
+
+    if (memcmp(begin, CHANNEL_TRACE_MAGIC, 4) != 0 || header[0] != CHANNEL_TRACE_VERSION || header[1] <= 0) {
+        close();
+        return false;
+    }
+
+    channel_size = header[1];
+    cursor = begin + TRACE_HEADER_SIZE;
+    corrupted = false;
+
+    return true;
+}
+
+uint64_t ChannelTraceReader::nextRun(const uint8_t *& states) {
+
+    uint64_t run = 0;
+    int shift = 0;
+    size_t packed_size = (channel_size + 3) / 4;
+
+    while (cursor < end && shift < 64) {
+
+        uint8_t byte = *cursor++;
+        run |= (uint64_t) (byte & 0x7f) << shift;
+        shift += 7;
+
+        if ((byte & 0x80) == 0) {
+
+            // The writer never stores an empty run, and the states must follow in full.
+            if (run == 0 || (size_t) (end - cursor) < packed_size)
+                break;
+
+            states = cursor;
+            cursor += packed_size;
+            return run;
+        }
+    }
+
+    // A varint longer than 64 bits or cut by the end of the file, an empty run or truncated states.
+    if (shift > 0) {
+        corrupted = true;
+        cursor = end;
+    }
+
+    return 0;
+}
+
+void ChannelTraceReader::close() {
+
+    if (begin != 0)
+        munmap((void*) begin, length);
+
+    begin = cursor = end = 0;
+    length = 0;
+}
@@ -0,0 +1,100 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#ifndef __SRAWN_CHANNELTRACE_H_
+#define __SRAWN_CHANNELTRACE_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+/*
+ * Binary per-slot channel activity trace.
+ *
+ * Header: the 4 bytes "SRCT", then the version and the number of channels (int32 each, little endian).
+ * Body:   a sequence of runs. Each run is an unsigned LEB128 varint with the number of consecutive
+ *         identical slots, followed by the state of every channel packed in 2 bits
+ *         (4 channels per byte, channel 0 in the lowest bits).
+ */
+
+#define CHANNEL_TRACE_MAGIC "SRCT"
+#define CHANNEL_TRACE_VERSION 1
+
+// State of a channel during one slot.
+
+enum ChannelState {
+    CHANNEL_IDLE = 0,           //  No transmission
+    CHANNEL_SUCCESS = 1,        //  Exactly one transmission
+    CHANNEL_COLLISION = 2       //  More than one transmission
+};
+
+class ChannelTraceWriter
+{
+private:
+    FILE *file;
+    int channel_size;
+    std::vector<uint8_t> current;       //  Packed states of the current run
+    std::vector<uint8_t> slot;          //  Packed states of the slot being recorded
+    uint64_t run_length;
+
+public:
+    ChannelTraceWriter();
+    ~ChannelTraceWriter();
+
+    bool open(const char *path, int channel_size);
+    bool isOpen() const { return file != 0; }
+
+    // It records the state of the channels in the next slot: "attempts" holds the number of transmissions on each channel.
+    void recordSlot(const int *attempts);
+    // It records "count" slots in which every channel is idle.
+    void recordIdleSlots(uint64_t count);
+    void close();
+
+protected:
+    void flushRun();
+};
+
+/**
+ * The trace is memory-mapped and decoded one run at a time.
+ */
+class ChannelTraceReader
+{
+private:
+    const uint8_t *begin;
+    const uint8_t *cursor;
+    const uint8_t *end;
+    size_t length;
+    int channel_size;
+    bool corrupted;
+
+public:
+    ChannelTraceReader();
+    ~ChannelTraceReader();
+
+    bool open(const char *path);
+    int getChannelSize() const { return channel_size; }
+
+    // It returns the length of the next run and points "states" to its packed states; 0 when the trace is over or corrupted.
+    uint64_t nextRun(const uint8_t *& states);
+    bool isCorrupted() const { return corrupted; }
+    void close();
+
+    static int state(const uint8_t *states, int channel) {
+        return (states[channel >> 2] >> ((channel & 3) * 2)) & 3;
+    }
+};
+
+#endif
@@ -0,0 +1,163 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#include "ColumnarOutputVectorManager.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <sys/stat.h>
+
+Register_Class(ColumnarOutputVectorManager);
+
+Register_PerRunConfigOption(CFGID_COLUMNAR_VECTOR_FILE, "columnar-vector-file", CFG_FILENAME, "${resultdir}/${configname}-${runnumber}.vecc", "Name of the compressed columnar output vector file, when ColumnarOutputVectorManager is selected.");
+Register_PerRunConfigOption(CFGID_COLUMNAR_VECTOR_BLOCK_SIZE, "columnar-vector-block-size", CFG_INT, "4096", "Records of a vector buffered before they are compressed into a block.");
+Register_PerRunConfigOption(CFGID_COLUMNAR_VECTOR_COMPRESSION_LEVEL, "columnar-vector-compression-level", CFG_INT, "1", "zlib compression level of the blocks: 1 fastest .. 9 smallest.");
+Register_PerRunConfigOption(CFGID_COLUMNAR_VECTOR_MAX_PENDING_BLOCKS, "columnar-vector-max-pending-blocks", CFG_INT, "64", "Blocks waiting for the writer thread before the simulation waits for it.");
+
+ColumnarOutputVectorManager::ColumnarOutputVectorManager()
+{
+    next_id = 0;
+    block_size = 4096;
+    compression_level = 1;
+    max_pending_blocks = 64;
+}
+
+ColumnarOutputVectorManager::~ColumnarOutputVectorManager()
+{
+    for (std::set<Vector*>::iterator it = vectors.begin(); it != vectors.end(); ++it)
+        delete *it;
+}
+
+void ColumnarOutputVectorManager::startRun()
+{
+    cConfigurationEx *cfg = getEnvir()->getConfigEx();
+
+    file_name = cfg->getAsFilename(CFGID_COLUMNAR_VECTOR_FILE);
+    run_id = cfg->getVariable("runid");
+    block_size = std::max((long) cfg->getAsInt(CFGID_COLUMNAR_VECTOR_BLOCK_SIZE), 1L);
+    compression_level = (int) cfg->getAsInt(CFGID_COLUMNAR_VECTOR_COMPRESSION_LEVEL);
+    max_pending_blocks = std::max((long) cfg->getAsInt(CFGID_COLUMNAR_VECTOR_MAX_PENDING_BLOCKS), 1L);
+    next_id = 0;
+
+    // As the text manager does: the file of a previous run is removed, the new one is created at the first record.
+    remove(file_name.c_str());
+}
+
+void ColumnarOutputVectorManager::endRun()
+{
+    if (!writer.isOpen())
+        return;
+
+    for (std::set<Vector*>::iterator it = vectors.begin(); it != vectors.end(); ++it)
+        writeBuffer(*it);
+
+    if (!writer.close())
+        throw cRuntimeError("Cannot write the columnar output vector file %s", file_name.c_str());
+}
+
+void ColumnarOutputVectorManager::openFile()
+{
+    // The result directory may not exist yet.
+    const char *slash = strrchr(file_name.c_str(), '/');
+    if (slash)
+        mkdir(std::string(file_name.c_str(), slash).c_str(), 0755);
+
+    if (!writer.open(file_name.c_str(), run_id, SimTime::getScaleExp(), compression_level, max_pending_blocks))
+        throw cRuntimeError("Cannot create the columnar output vector file %s", file_name.c_str());
+}
+
+void *ColumnarOutputVectorManager::registerVector(const char *modulename, const char *vectorname)
+{
+    Vector *vector = new Vector();
+    vector->info.id = next_id++;
+    vector->info.module = modulename;
+    vector->info.name = vectorname;
+    vector->declared = false;
+
+    // vector-recording is honoured per object, as by the text manager.
+    std::string object = std::string(modulename) + "." + vectorname;
+    const char *recording = getEnvir()->getConfig()->getPerObjectConfigValue(object.c_str(), "vector-recording");
+    vector->enabled = !recording || strcmp(recording, "false") != 0;
+
+    vectors.insert(vector);
+
+    return vector;
+}
+
+void ColumnarOutputVectorManager::deregisterVector(void *vechandle)
+{
+    Vector *vector = (Vector*) vechandle;
+
+    if (writer.isOpen())
+        writeBuffer(vector);
+
+    vectors.erase(vector);
+    delete vector;
+}
+
+void ColumnarOutputVectorManager::setVectorAttribute(void *vechandle, const char *name, const char *value)
+{
+    Vector *vector = (Vector*) vechandle;
+    vector->info.attributes.push_back(std::make_pair(std::string(name), std::string(value)));
+}
+
+bool ColumnarOutputVectorManager::record(void *vechandle, simtime_t t, double value)
+{
+    Vector *vector = (Vector*) vechandle;
+
+    if (!vector->enabled)
+        return false;
+
+    // The declaration comes with the first record: the attributes are set by then.
+    if (!vector->declared) {
+        if (!writer.isOpen())
+            openFile();
+        writer.declare(vector->info);
+        vector->declared = true;
+    }
+
+    ColumnarRecords& buffer = vector->buffer;
+
+    // The writer takes the columns of every block: the next block gets fresh ones.
+    if (buffer.times.capacity() == 0) {
+        buffer.times.reserve(block_size);
+        buffer.events.reserve(block_size);
+        buffer.values.reserve(block_size);
+    }
+
+    buffer.times.push_back(SIMTIME_RAW(t));
+    buffer.events.push_back(getSimulation()->getEventNumber());
+    buffer.values.push_back(value);
+
+    if (buffer.size() >= block_size)
+        writeBuffer(vector);
+
+    return true;
+}
+
+void ColumnarOutputVectorManager::writeBuffer(Vector *vector)
+{
+    if (vector->buffer.size() == 0)
+        return;
+
+    writer.writeBlock(vector->info.id, vector->buffer);
+}
+
+void ColumnarOutputVectorManager::flush()
+{
+    // Partial blocks are not cut short, they would compress badly: the full ones are already on
+    // their way to the writer thread, the others are written at the end of the run.
+}
@@ -0,0 +1,75 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#ifndef __SRAWN_COLUMNAROUTPUTVECTORMANAGER_H_
+#define __SRAWN_COLUMNAROUTPUTVECTORMANAGER_H_
+
+#include <omnetpp.h>
+#include <set>
+#include <string>
+
+#include "ColumnarVector.h"
+
+using namespace omnetpp;
+
+/**
+ * Output vector manager writing compressed columnar files ( .vecc, see ColumnarVector.h ) in
+ * place of the text .vec files: select it with
+ *     outputvectormanager-class = "ColumnarOutputVectorManager"
+ * Every vector buffers columnar-vector-block-size records, then hands them to the background
+ * writer thread. tools/vecconvert turns a .vecc file back into a standard .vec file.
+ */
+class ColumnarOutputVectorManager : public cIOutputVectorManager
+{
+private:
+    struct Vector {
+        ColumnarVectorInfo info;
+        bool enabled;
+        bool declared;
+        ColumnarRecords buffer;
+    };
+
+    ColumnarVectorWriter writer;
+    std::string file_name;
+    std::string run_id;
+    uint32_t next_id;
+    size_t block_size;
+    int compression_level;
+    size_t max_pending_blocks;
+
+    // Registered vectors: their buffers are flushed at the end of the run.
+    std::set<Vector*> vectors;
+
+public:
+    ColumnarOutputVectorManager();
+    virtual ~ColumnarOutputVectorManager();
+
+    virtual void startRun() override;
+    virtual void endRun() override;
+
+    virtual void *registerVector(const char *modulename, const char *vectorname) override;
+    virtual void deregisterVector(void *vechandle) override;
+    virtual void setVectorAttribute(void *vechandle, const char *name, const char *value) override;
+    virtual bool record(void *vechandle, simtime_t t, double value) override;
+
+    virtual const char *getFileName() const override { return file_name.c_str(); }
+    virtual void flush() override;
+
+protected:
+    void openFile();
+    void writeBuffer(Vector *vector);
+};
+
+#endif
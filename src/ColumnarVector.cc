@@ -0,0 +1,571 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#include "ColumnarVector.h"
+
+#include <string.h>
+#include <zlib.h>
+
+#include <algorithm>
+
+/* ENCODING */
+
+static void putVarint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back((uint8_t) (value | 0x80));
+        value >>= 7;
+    }
+    out.push_back((uint8_t) value);
+}
+
+static void putZigzag(std::vector<uint8_t>& out, int64_t value) {
+    putVarint(out, ((uint64_t) value << 1) ^ (uint64_t) (value >> 63));
+}
+
+static void putString(std::vector<uint8_t>& out, const std::string& text) {
+    putVarint(out, text.size());
+    out.insert(out.end(), text.begin(), text.end());
+}
+
+static void putFixed(std::vector<uint8_t>& out, uint64_t value, int bytes) {
+    for (int b = 0; b < bytes; b++)
+        out.push_back((uint8_t) (value >> (8 * b)));
+}
+
+static uint64_t bitsOf(double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static double doubleOf(uint64_t bits) {
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// Decoding cursor: "ok" becomes false as soon as the data are truncated.
+
+struct Cursor {
+    const uint8_t *p;
+    const uint8_t *end;
+    bool ok;
+
+    Cursor(const uint8_t *p, const uint8_t *end) : p(p), end(end), ok(true) {}
+
+    uint64_t varint() {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (p >= end) {
+                ok = false;
+                return 0;
+            }
+            uint8_t byte = *p++;
+            value |= (uint64_t) (byte & 0x7f) << shift;
+            if (!(byte & 0x80))
+                return value;
+        }
+        ok = false;
+        return 0;
+    }
+
+    int64_t zigzag() {
+        uint64_t value = varint();
+        return (int64_t) (value >> 1) ^ -(int64_t) (value & 1);
+    }
+
+    std::string string() {
+        uint64_t length = varint();
+        if (!ok || (uint64_t) (end - p) < length) {
+            ok = false;
+            return "";
+        }
+        std::string text((const char*) p, length);
+        p += length;
+        return text;
+    }
+};
+
+static void putDeclaration(std::vector<uint8_t>& out, const ColumnarVectorInfo& vector) {
+    putVarint(out, vector.id);
+    putString(out, vector.module);
+    putString(out, vector.name);
+    putVarint(out, vector.attributes.size());
+    for (size_t a = 0; a < vector.attributes.size(); a++) {
+        putString(out, vector.attributes[a].first);
+        putString(out, vector.attributes[a].second);
+    }
+}
+
+static ColumnarVectorInfo getDeclaration(Cursor& in) {
+    ColumnarVectorInfo vector;
+    vector.id = in.varint();
+    vector.module = in.string();
+    vector.name = in.string();
+    uint64_t attributes = in.varint();
+    for (uint64_t a = 0; in.ok && a < attributes; a++) {
+        std::string name = in.string();
+        vector.attributes.push_back(std::make_pair(name, in.string()));
+    }
+    return vector;
+}
+
+/**
+ * Block payload: vector id, records, raw length, compressed columns.
+ */
+static bool encodeBlock(uint32_t vector_id, const ColumnarRecords& records, int level, std::vector<uint8_t>& payload) {
+
+    std::vector<uint8_t> raw;
+    raw.reserve(records.size() * 6);
+
+    int64_t previous = 0;
+    for (size_t r = 0; r < records.size(); r++) {
+        putZigzag(raw, records.times[r] - previous);
+        previous = records.times[r];
+    }
+
+    previous = 0;
+    for (size_t r = 0; r < records.size(); r++) {
+        putZigzag(raw, records.events[r] - previous);
+        previous = records.events[r];
+    }
+
+    uint64_t previous_bits = 0;
+    for (size_t r = 0; r < records.size(); r++) {
+        uint64_t bits = bitsOf(records.values[r]);
+        putVarint(raw, bits ^ previous_bits);
+        previous_bits = bits;
+    }
+
+    payload.clear();
+    putVarint(payload, vector_id);
+    putVarint(payload, records.size());
+    putVarint(payload, raw.size());
+
+    size_t header = payload.size();
+    uLongf compressed = compressBound(raw.size());
+    payload.resize(header + compressed);
+
+    if (compress2(&payload[header], &compressed, raw.empty() ? (const Bytef*) "" : &raw[0], raw.size(), level) != Z_OK)
+        return false;
+
+    payload.resize(header + compressed);
+
+    return true;
+}
+
+static bool decodeBlock(const std::vector<uint8_t>& payload, uint32_t& vector_id, ColumnarRecords& records) {
+
+    Cursor in(payload.empty() ? 0 : &payload[0], payload.empty() ? 0 : &payload[0] + payload.size());
+
+    vector_id = in.varint();
+    uint64_t count = in.varint();
+    uint64_t length = in.varint();
+    if (!in.ok)
+        return false;
+
+    // The lengths come from the file: before allocating, reject what no writer can produce. Deflate cannot
+    // expand more than COLUMNAR_MAX_EXPANSION times, and a record takes at least a byte in each column.
+    if (length > (uint64_t) (in.end - in.p) * COLUMNAR_MAX_EXPANSION || count > length / 3)
+        return false;
+
+    uLongf raw_length = length;
+    std::vector<uint8_t> raw(raw_length);
+    if (raw_length > 0 && uncompress(&raw[0], &raw_length, in.p, in.end - in.p) != Z_OK)
+        return false;
+
+    Cursor columns(raw.empty() ? 0 : &raw[0], raw.empty() ? 0 : &raw[0] + raw_length);
+
+    records.clear();
+    records.times.resize(count);
+    records.events.resize(count);
+    records.values.resize(count);
+
+    int64_t previous = 0;
+    for (uint64_t r = 0; r < count; r++)
+        records.times[r] = previous += columns.zigzag();
+
+    previous = 0;
+    for (uint64_t r = 0; r < count; r++)
+        records.events[r] = previous += columns.zigzag();
+
+    uint64_t previous_bits = 0;
+    for (uint64_t r = 0; r < count; r++) {
+        previous_bits ^= columns.varint();
+        records.values[r] = doubleOf(previous_bits);
+    }
+
+    return columns.ok;
+}
+
+/* WRITER */
+
+ColumnarVectorWriter::ColumnarVectorWriter() {
+
+    file = 0;
+    offset = 0;
+    level = Z_DEFAULT_COMPRESSION;
+    max_pending = 0;
+    failed = false;
+    stopping = false;
+}
+
+ColumnarVectorWriter::~ColumnarVectorWriter() {
+
+    close();
+}
+
+bool ColumnarVectorWriter::open(const char *path, const std::string& run, int scale_exponent, int level, size_t max_pending) {
+
+    close();
+
+    file = fopen(path, "wb");
+    if (!file)
+        return false;
+
+    this->level = level;
+    this->max_pending = max_pending > 0 ? max_pending : 1;
+    failed = false;
+    stopping = false;
+    declarations.clear();
+    index.clear();
+
+    std::vector<uint8_t> header(COLUMNAR_MAGIC, COLUMNAR_MAGIC + 8);
+    putZigzag(header, scale_exponent);
+    putString(header, run);
+
+    failed = fwrite(&header[0], 1, header.size(), file) != header.size();
+    offset = header.size();
+
+    writer = std::thread(&ColumnarVectorWriter::run, this);
+
+    return true;
+}
+
+void ColumnarVectorWriter::declare(const ColumnarVectorInfo& vector) {
+
+    Job job;
+    job.is_block = false;
+    job.declaration = vector;
+    enqueue(job);
+}
+
+void ColumnarVectorWriter::writeBlock(uint32_t vector_id, ColumnarRecords& records) {
+
+    if (records.size() == 0)
+        return;
+
+    Job job;
+    job.is_block = true;
+    job.vector_id = vector_id;
+    job.records.times.swap(records.times);
+    job.records.events.swap(records.events);
+    job.records.values.swap(records.values);
+    enqueue(job);
+}
+
+void ColumnarVectorWriter::enqueue(Job& job) {
+
+    std::unique_lock<std::mutex> lock(mutex);
+
+    // Back-pressure: the simulation cannot run too far ahead of the disk.
+    job_done.wait(lock, [this]() { return jobs.size() < max_pending; });
+
+    jobs.push_back(Job());
+    std::swap(jobs.back(), job);
+    job_ready.notify_one();
+}
+
+void ColumnarVectorWriter::run() {
+
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (true) {
+
+        job_ready.wait(lock, [this]() { return !jobs.empty() || stopping; });
+
+        if (jobs.empty())
+            return;
+
+        Job job;
+        std::swap(job, jobs.front());
+        jobs.pop_front();
+
+        // The job at hand is written while the simulation queues the next ones.
+        lock.unlock();
+        writeJob(job);
+        lock.lock();
+
+        job_done.notify_all();
+    }
+}
+
+void ColumnarVectorWriter::writeChunk(char type, const std::vector<uint8_t>& payload) {
+
+    std::vector<uint8_t> header;
+    header.push_back((uint8_t) type);
+    putFixed(header, payload.size(), 4);
+
+    if (fwrite(&header[0], 1, header.size(), file) != header.size()
+            || (payload.size() > 0 && fwrite(&payload[0], 1, payload.size(), file) != payload.size()))
+        failed = true;
+
+    offset += header.size() + payload.size();
+}
+
+void ColumnarVectorWriter::writeJob(Job& job) {
+
+    std::vector<uint8_t> payload;
+
+    if (!job.is_block) {
+        putDeclaration(payload, job.declaration);
+        writeChunk(COLUMNAR_DECLARATION, payload);
+        declarations.push_back(job.declaration);
+        return;
+    }
+
+    if (!encodeBlock(job.vector_id, job.records, level, payload)) {
+        failed = true;
+        return;
+    }
+
+    ColumnarBlockInfo block;
+    block.vector_id = job.vector_id;
+    block.offset = offset;
+    block.count = job.records.size();
+    block.first_time = job.records.times.front();
+    block.last_time = job.records.times.back();
+    index.push_back(block);
+
+    writeChunk(COLUMNAR_BLOCK, payload);
+}
+
+bool ColumnarVectorWriter::close() {
+
+    if (!file)
+        return !failed;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        job_ready.notify_one();
+    }
+    writer.join();
+
+    // Index and footer.
+    uint64_t index_offset = offset;
+    std::vector<uint8_t> payload;
+
+    putVarint(payload, declarations.size());
+    for (size_t v = 0; v < declarations.size(); v++)
+        putDeclaration(payload, declarations[v]);
+
+    putVarint(payload, index.size());
+    for (size_t b = 0; b < index.size(); b++) {
+        putVarint(payload, index[b].vector_id);
+        putVarint(payload, index[b].offset);
+        putVarint(payload, index[b].count);
+        putZigzag(payload, index[b].first_time);
+        putZigzag(payload, index[b].last_time);
+    }
+
+    writeChunk(COLUMNAR_INDEX, payload);
+
+    std::vector<uint8_t> footer;
+    putFixed(footer, index_offset, 8);
+    footer.insert(footer.end(), COLUMNAR_INDEX_MAGIC, COLUMNAR_INDEX_MAGIC + 8);
+
+    if (fwrite(&footer[0], 1, footer.size(), file) != footer.size())
+        failed = true;
+
+    if (fclose(file) != 0)
+        failed = true;
+
+    file = 0;
+
+    return !failed;
+}
+
+/* READER */
+
+ColumnarVectorReader::ColumnarVectorReader() {
+
+    file = 0;
+    scale_exponent = 0;
+}
+
+ColumnarVectorReader::~ColumnarVectorReader() {
+
+    close();
+}
+
+// It reads the chunk at the current position: false at the end of the file or on a truncated chunk.
+static bool readChunk(FILE *file, char& type, std::vector<uint8_t>& payload) {
+
+    uint8_t header[5];
+    if (fread(header, 1, 5, file) != 5)
+        return false;
+
+    type = (char) header[0];
+    uint32_t length = header[1] | (header[2] << 8) | (header[3] << 16) | ((uint32_t) header[4] << 24);
+
+    // The length comes from the file too: the payload grows as it is read, so that a corrupted length
+    // fails at the end of the file instead of allocating up to 4 GiB.
+    payload.clear();
+    while (payload.size() < length) {
+        size_t done = payload.size();
+        size_t piece = std::min<size_t>(length - done, 1 << 20);
+        payload.resize(done + piece);
+        if (fread(&payload[done], 1, piece, file) != piece)
+            return false;
+    }
+
+    return true;
+}
+
+bool ColumnarVectorReader::open(const char *path) {
+
+    close();
+
+    file = fopen(path, "rb");
+    if (!file)
+        return false;
+
+    // The header is short: 4 KiB hold it whatever the run identifier is, up to 4000 characters.
+    uint8_t header[4096];
+    size_t length = fread(header, 1, sizeof(header), file);
+
+    if (length < 8 || memcmp(header, COLUMNAR_MAGIC, 8) != 0) {
+        close();
+        return false;
+    }
+
+    Cursor in(header + 8, header + length);
+    scale_exponent = in.zigzag();
+    run = in.string();
+
+    if (!in.ok) {
+        close();
+        return false;
+    }
+
+    long body = in.p - header;
+
+    if (readIndex())
+        return true;
+
+    // No index: the chunks are scanned from the beginning of the body.
+    vectors.clear();
+    blocks.clear();
+    fseek(file, body, SEEK_SET);
+
+    return scanChunks();
+}
+
+bool ColumnarVectorReader::readIndex() {
+
+    uint8_t footer[16];
+
+    if (fseek(file, -16, SEEK_END) != 0 || fread(footer, 1, 16, file) != 16
+            || memcmp(footer + 8, COLUMNAR_INDEX_MAGIC, 8) != 0)
+        return false;
+
+    uint64_t index_offset = 0;
+    for (int b = 0; b < 8; b++)
+        index_offset |= (uint64_t) footer[b] << (8 * b);
+
+    char type;
+    std::vector<uint8_t> payload;
+
+    if (fseek(file, index_offset, SEEK_SET) != 0 || !readChunk(file, type, payload) || type != COLUMNAR_INDEX)
+        return false;
+
+    Cursor in(payload.empty() ? 0 : &payload[0], payload.empty() ? 0 : &payload[0] + payload.size());
+
+    uint64_t declarations = in.varint();
+    for (uint64_t v = 0; in.ok && v < declarations; v++) {
+        ColumnarVectorInfo vector = getDeclaration(in);
+        vectors[vector.id] = vector;
+    }
+
+    uint64_t count = in.varint();
+    for (uint64_t b = 0; in.ok && b < count; b++) {
+        ColumnarBlockInfo block;
+        block.vector_id = in.varint();
+        block.offset = in.varint();
+        block.count = in.varint();
+        block.first_time = in.zigzag();
+        block.last_time = in.zigzag();
+        blocks.push_back(block);
+    }
+
+    return in.ok;
+}
+
+bool ColumnarVectorReader::scanChunks() {
+
+    char type;
+    std::vector<uint8_t> payload;
+    long position = ftell(file);
+
+    while (readChunk(file, type, payload)) {
+
+        if (type == COLUMNAR_DECLARATION) {
+            Cursor in(payload.empty() ? 0 : &payload[0], payload.empty() ? 0 : &payload[0] + payload.size());
+            ColumnarVectorInfo vector = getDeclaration(in);
+            if (in.ok)
+                vectors[vector.id] = vector;
+        }
+
+        else if (type == COLUMNAR_BLOCK) {
+            ColumnarBlockInfo block;
+            ColumnarRecords records;
+            if (!decodeBlock(payload, block.vector_id, records) || records.size() == 0)
+                break;
+            block.offset = position;
+            block.count = records.size();
+            block.first_time = records.times.front();
+            block.last_time = records.times.back();
+            blocks.push_back(block);
+        }
+
+        else
+            break;
+
+        position = ftell(file);
+    }
+
+    return true;
+}
+
+bool ColumnarVectorReader::readBlock(const ColumnarBlockInfo& block, ColumnarRecords& records) {
+
+    char type;
+    std::vector<uint8_t> payload;
+    uint32_t vector_id;
+
+    if (!file || fseek(file, block.offset, SEEK_SET) != 0 || !readChunk(file, type, payload) || type != COLUMNAR_BLOCK)
+        return false;
+
+    return decodeBlock(payload, vector_id, records) && vector_id == block.vector_id;
+}
+
+void ColumnarVectorReader::close() {
+
+    if (file)
+        fclose(file);
+
+    file = 0;
+}
@@ -0,0 +1,160 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+#ifndef __SRAWN_COLUMNARVECTOR_H_
+#define __SRAWN_COLUMNARVECTOR_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/*
+ * Columnar output vectors ( .vecc ).
+ *
+ * Header: the 8 bytes "SRAWNVC1", the simulation time scale exponent ( zigzag varint ) and the run identifier.
+ * Body:   a sequence of chunks, each one a type byte, a payload length ( uint32, little endian ) and the payload.
+ *  - 'V' vector declaration: id, module, name and attributes ( name, value ).
+ *  - 'B' block of one vector: id, number of records, raw length, then the zlib-compressed columns:
+ *        times ( raw simulation time ticks ) and event numbers as zigzag varint deltas,
+ *        values as the XOR with the previous value ( varint ).
+ *  - 'I' index: the declarations, then for every block its vector, offset, records and time range.
+ * Footer: the offset of the index ( uint64, little endian ) and the 8 bytes "SRAWNIDX".
+ * Integers are unsigned LEB128 varints and strings are a varint length followed by the bytes.
+ * A file without footer ( e.g. the run crashed ) can still be read by scanning its chunks.
+ */
+
+#define COLUMNAR_MAGIC "SRAWNVC1"
+#define COLUMNAR_INDEX_MAGIC "SRAWNIDX"
+#define COLUMNAR_MAX_EXPANSION 1032     //  Largest ratio of raw to compressed length that zlib can reach
+
+enum ColumnarChunkType {
+    COLUMNAR_DECLARATION = 'V',
+    COLUMNAR_BLOCK = 'B',
+    COLUMNAR_INDEX = 'I'
+};
+
+struct ColumnarVectorInfo {
+    uint32_t id;
+    std::string module;
+    std::string name;
+    std::vector< std::pair<std::string, std::string> > attributes;
+};
+
+struct ColumnarBlockInfo {
+    uint32_t vector_id;
+    uint64_t offset;            //  Offset of the chunk in the file
+    uint32_t count;
+    int64_t first_time;         //  Raw simulation time of the first and of the last record
+    int64_t last_time;
+};
+
+// Columns of the records of one vector.
+
+struct ColumnarRecords {
+    std::vector<int64_t> times;
+    std::vector<int64_t> events;
+    std::vector<double> values;
+
+    size_t size() const { return times.size(); }
+    void clear() { times.clear(); events.clear(); values.clear(); }
+};
+
+/**
+ * The writer compresses and writes the blocks on a background thread: the simulation only hands
+ * over full buffers. At most max_pending blocks can wait, then the caller waits for the writer.
+ */
+class ColumnarVectorWriter
+{
+private:
+    struct Job {
+        bool is_block;
+        ColumnarVectorInfo declaration;
+        uint32_t vector_id;
+        ColumnarRecords records;
+    };
+
+    FILE *file;
+    uint64_t offset;
+    int level;
+    size_t max_pending;
+    bool failed;
+    bool stopping;
+
+    std::vector<ColumnarVectorInfo> declarations;
+    std::vector<ColumnarBlockInfo> index;
+
+    std::deque<Job> jobs;
+    std::mutex mutex;
+    std::condition_variable job_ready;
+    std::condition_variable job_done;
+    std::thread writer;
+
+public:
+    ColumnarVectorWriter();
+    ~ColumnarVectorWriter();
+
+    // Compression level of zlib ( 1 fastest .. 9 smallest ).
+    bool open(const char *path, const std::string& run, int scale_exponent, int level, size_t max_pending);
+    bool isOpen() const { return file != 0; }
+
+    void declare(const ColumnarVectorInfo& vector);
+    // The records are moved to the writer: "records" is left empty.
+    void writeBlock(uint32_t vector_id, ColumnarRecords& records);
+    // It waits for the pending blocks, writes index and footer and closes the file: false on any write error.
+    bool close();
+
+protected:
+    void enqueue(Job& job);
+    void run();
+    void writeChunk(char type, const std::vector<uint8_t>& payload);
+    void writeJob(Job& job);
+};
+
+/**
+ * The reader loads the declarations and the index ( or scans the chunks ) and decodes single blocks,
+ * so a vector or a time range can be read without decoding the rest of the file.
+ */
+class ColumnarVectorReader
+{
+private:
+    FILE *file;
+
+public:
+    std::string run;
+    int scale_exponent;
+    std::map<uint32_t, ColumnarVectorInfo> vectors;
+    std::vector<ColumnarBlockInfo> blocks;
+
+    ColumnarVectorReader();
+    ~ColumnarVectorReader();
+
+    bool open(const char *path);
+    bool readBlock(const ColumnarBlockInfo& block, ColumnarRecords& records);
+    void close();
+
+protected:
+    bool readIndex();
+    bool scanChunks();
+};
+
+#endif
@@ -0,0 +1,261 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#include "EnsembleEngine.h"
+#include "RandomStreams.h"
+
+#include <math.h>
+
+Define_Module(EnsembleEngine);
+
+EnsembleEngine::EnsembleEngine() {
+
+    slotBeep = 0;
+    slot_counter = 0;
+    measured_slots = 0;
+}
+
+EnsembleEngine::~EnsembleEngine() {
+
+    for (size_t k = 0; k < delay_vectors.size(); k++)
+        delete delay_vectors[k];
+
+    for (size_t k = 0; k < queue_vectors.size(); k++)
+        delete queue_vectors[k];
+}
+
+void EnsembleEngine::initialize() {
+
+    lanes = (int) par("lanes");
+    transmitter_size = (int) par("transmitter_size");
+    channel_size = (int) par("channel_size");
+    slot_time = par("slot_time").doubleValue();
+    mean_time = par("exponential_send_mean_time").doubleValue();
+
+    // Bernoullian probability, as in Transmitter.
+    if (par("bernoullian_prob").doubleValue() >= 0)
+        bernoullian_prob = par("bernoullian_prob").doubleValue();
+    else if (channel_size > transmitter_size)
+        bernoullian_prob = 1;
+    else
+        bernoullian_prob = channel_size / (double) transmitter_size;
+
+    int states = transmitter_size * lanes;
+
+    slot_to_wait.assign(states, 0);
+    collision_number_per_packet.assign(states, 0);
+    extracted_channel.assign(states, -1);
+    attempting.assign(states, 0);
+    queue.assign(states, std::deque<double>());
+
+    // The generators send their first packet at time 0.
+    next_arrival.assign(states, 0);
+
+    channels.assign(channel_size * lanes, 0);
+
+    // One stream per lane: lane k of seed-set s draws the same numbers in every run.
+    streams.resize(lanes);
+    for (int k = 0; k < lanes; k++)
+        streams[k].seed(RandomStreams::currentSeedSet(), k, false);
+
+    channel_successes.assign(channel_size * lanes, 0);
+    queue_length_sum.assign(lanes, 0);
+    delay_sum.assign(lanes, 0);
+    delivered_packets.assign(lanes, 0);
+    all_channel_successes.assign(channel_size * lanes, 0);
+
+    // The vectors of the reference model, one set per lane: "delay_time:lane<k>" and so on.
+    for (int k = 0; k < lanes; k++) {
+
+        char name[64];
+
+        sprintf(name, "delay_time:lane%d", k);
+        delay_vectors.push_back(new cOutputVector(name));
+
+        sprintf(name, "queue_dimension_per_slot_time:lane%d", k);
+        queue_vectors.push_back(new cOutputVector(name));
+    }
+
+    slotBeep = new cMessage("ensemble slot beep");
+    scheduleAt(slot_time, slotBeep);
+}
+
+void EnsembleEngine::handleMessage(cMessage *msg) {
+
+    ASSERT(msg == slotBeep);
+
+    advanceSlot();
+    scheduleAt(simTime() + slot_time, slotBeep);
+}
+
+/**
+ * One slot of every lane: the arrivals before the slot beep, the beep ( channel extraction, backoff,
+ * bernoullian test ), the collision detection and the clear. The delay is measured up to the transmission.
+ */
+void EnsembleEngine::advanceSlot() {
+
+    slot_counter++;
+
+    double now = slot_counter * slot_time;
+    bool measured = (now > SIMTIME_DBL(getSimulation()->getWarmupPeriod()));
+
+    if (measured)
+        measured_slots++;
+
+    std::vector<double> queued(lanes, 0);
+
+    // Arrivals and beep.
+    for (int t = 0; t < transmitter_size; t++) {
+
+        for (int k = 0; k < lanes; k++) {
+
+            int s = t * lanes + k;
+            Xoshiro256& rng = streams[k];
+
+            while (next_arrival[s] < now) {
+                queue[s].push_back(next_arrival[s]);
+                next_arrival[s] += -mean_time * log(1 - rng.doubleRand());
+            }
+
+            // Queue length per slot, sampled at the beep as the transmitters do.
+            queued[k] += queue[s].size();
+
+            attempting[s] = 0;
+
+            if (queue[s].empty())
+                continue;
+
+            if (extracted_channel[s] == -1)
+                extracted_channel[s] = (int) (rng.doubleRand() * channel_size);
+            else if (slot_to_wait[s] > 0) {
+                slot_to_wait[s]--;
+                continue;
+            }
+
+            if (rng.doubleRand() < bernoullian_prob) {
+                attempting[s] = 1;
+                channels[extracted_channel[s] * lanes + k]++;
+            }
+        }
+    }
+
+    // Collision detection.
+    for (int t = 0; t < transmitter_size; t++) {
+
+        for (int k = 0; k < lanes; k++) {
+
+            int s = t * lanes + k;
+            if (!attempting[s])
+                continue;
+
+            int channel = extracted_channel[s];
+
+            if (channels[channel * lanes + k] > 1) {
+
+                double range = pow(2, (collision_number_per_packet[s] + 1));
+                slot_to_wait[s] = (int) (1 + (range - 1) * streams[k].doubleRand());
+                collision_number_per_packet[s]++;
+                continue;
+            }
+
+            all_channel_successes[channel * lanes + k]++;
+
+            if (measured) {
+                channel_successes[channel * lanes + k]++;
+                delay_sum[k] += now - queue[s].front();
+                delivered_packets[k]++;
+                delay_vectors[k]->record(now - queue[s].front());
+            }
+
+            queue[s].pop_front();
+            extracted_channel[s] = -1;
+            collision_number_per_packet[s] = 0;
+        }
+    }
+
+    // Clear.
+    for (size_t i = 0; i < channels.size(); i++)
+        channels[i] = 0;
+
+    // One sample per slot: the mean over the transmitters of the lane, whose mean over the run is the
+    // one of the N samples per slot of the reference.
+    if (measured)
+        for (int k = 0; k < lanes; k++) {
+            queue_length_sum[k] += queued[k];
+            queue_vectors[k]->record(queued[k] / transmitter_size);
+        }
+}
+
+void EnsembleEngine::finish() {
+
+    cancelAndDelete(slotBeep);
+    slotBeep = 0;
+
+    std::vector<double> throughput(lanes, 0), queue_length(lanes), delay(lanes);
+
+    for (int j = 0; j < channel_size; j++) {
+
+        std::vector<double> channel_throughput(lanes);
+
+        for (int k = 0; k < lanes; k++) {
+            channel_throughput[k] = (measured_slots > 0) ? channel_successes[j * lanes + k] / measured_slots : 0;
+            throughput[k] += channel_throughput[k];
+        }
+
+        char name[64];
+        sprintf(name, "ensemble_channel_throughput%d", j);
+        recordEnsemble(name, channel_throughput);
+
+        // The last value of channel_throughput<j> in the reference: the successes since the beginning
+        // of the run over all the slots.
+        for (int k = 0; k < lanes; k++) {
+
+            sprintf(name, "channel_throughput%d:lane%d", j, k);
+            cOutputVector vector(name);
+            vector.record(slot_counter > 0 ? all_channel_successes[j * lanes + k] / slot_counter : 0);
+        }
+    }
+
+    for (int k = 0; k < lanes; k++) {
+        queue_length[k] = (measured_slots > 0) ? queue_length_sum[k] / ((double) measured_slots * transmitter_size) : 0;
+        delay[k] = (delivered_packets[k] > 0) ? delay_sum[k] / delivered_packets[k] : 0;
+    }
+
+    recordEnsemble("ensemble_total_throughput", throughput);
+    recordEnsemble("ensemble_mean_queue_length", queue_length);
+    recordEnsemble("ensemble_mean_delay", delay);
+
+    recordScalar("ensemble_lanes", lanes);
+}
+
+/**
+ * It records the value of every lane ( name:lane<k> ) and their mean and standard deviation.
+ */
+void EnsembleEngine::recordEnsemble(const char *name, const std::vector<double>& values) {
+
+    cStdDev stat;
+
+    for (size_t k = 0; k < values.size(); k++) {
+
+        char lane_name[96];
+        sprintf(lane_name, "%s:lane%d", name, (int) k);
+        recordScalar(lane_name, values[k]);
+
+        stat.collect(values[k]);
+    }
+
+    recordScalar((std::string(name) + ":mean").c_str(), stat.getMean());
+    recordScalar((std::string(name) + ":stddev").c_str(), stat.getStddev());
+}
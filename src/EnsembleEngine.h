@@ -0,0 +1,89 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#ifndef __SRAWN_ENSEMBLEENGINE_H_
+#define __SRAWN_ENSEMBLEENGINE_H_
+
+#include <omnetpp.h>
+#include <deque>
+#include <vector>
+
+#include "Xoshiro.h"
+
+using namespace omnetpp;
+
+/**
+ * K replicas of the transmitters of the model, advanced together slot by slot.
+ * The state of transmitter t in replica ( lane ) k is at index t * K + k: the loops over the lanes of a
+ * transmitter run over contiguous memory. They stay scalar ( per-lane draws, queues and branches ): the
+ * gain is the single event per slot for all the replicas. The model is the one of Transmitter and Generator: exponential
+ * arrivals, channel extraction, bernoullian test, binary exponential backoff after a collision.
+ * Every lane records the vectors of the reference model with a ":lane<k>" suffix, so that tools/equivalence
+ * can compare each lane with a run of the reference.
+ */
+class EnsembleEngine : public cSimpleModule
+{
+private:
+    cMessage *slotBeep;
+
+    int lanes;
+    int transmitter_size;
+    int channel_size;
+    double slot_time;
+    double mean_time;
+    double bernoullian_prob;
+
+    int slot_counter;
+
+    // Transmitter state [ transmitter * lane ].
+    std::vector<int> slot_to_wait;
+    std::vector<int> collision_number_per_packet;
+    std::vector<int> extracted_channel;
+    std::vector<int> attempting;                    //  1 if it transmits in this slot
+    std::vector<double> next_arrival;
+    std::vector< std::deque<double> > queue;        //  Generation times of the queued packets
+
+    // Channel state [ channel * lane ].
+    std::vector<int> channels;
+
+    // Random streams [ lane ].
+    std::vector<Xoshiro256> streams;
+
+    // Statistics after the warm-up period [ lane ], channel successes [ channel * lane ].
+    int measured_slots;
+    std::vector<double> channel_successes;
+    std::vector<double> queue_length_sum;
+    std::vector<double> delay_sum;
+    std::vector<double> delivered_packets;
+    std::vector<double> all_channel_successes;      //  From the beginning of the run [ channel * lane ]
+
+    // Vectors of every lane, as the reference records them.
+    std::vector<cOutputVector*> delay_vectors;
+    std::vector<cOutputVector*> queue_vectors;
+
+public:
+    EnsembleEngine();
+    virtual ~EnsembleEngine();
+
+protected:
+    virtual void initialize();
+    virtual void handleMessage(cMessage *msg);
+    virtual void finish();
+
+    void advanceSlot();
+    void recordEnsemble(const char *name, const std::vector<double>& values);
+};
+
+#endif
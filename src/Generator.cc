@@ -20,38 +20,170 @@ Define_Module(Generator);
 
 void Generator::initialize()
 {
+    // Interarrival-times come from the arrival stream of the generator.
+    random_streams.initialize(this, getIndex(), getParentModule(), GENERATOR_STREAMS);
+
+    last_generation_time = -1;
+
+    slot_time_domain = getParentModule()->par("slot_time_domain").boolValue();
+    simtime_t slot_time = getParentModule()->par("slot_time").doubleValue();
+    slot_time_raw = SIMTIME_RAW(slot_time);
 
     generation_event_message = new cMessage("generation event message");
+    memoryAllocated(MEMORY_CONTROL_MESSAGES, sizeof(cMessage));
+
+    // Arrival trace.
+    std::string mode = par("arrival_trace_mode").stdstringValue();
+
+    if (mode == "none")
+        trace_mode = TRACE_NONE;
+    else if (mode == "record")
+        trace_mode = TRACE_RECORD;
+    else if (mode == "replay")
+        trace_mode = TRACE_REPLAY;
+    else
+        throw cRuntimeError("Unknown arrival_trace_mode \"%s\"", mode.c_str());
+
+    if (trace_mode == TRACE_RECORD) {
+
+        if (!trace_writer.open(traceFileName().c_str()))
+            throw cRuntimeError("Cannot create the arrival trace %s", traceFileName().c_str());
+    }
+
+    else if (trace_mode == TRACE_REPLAY) {
+
+        if (!trace_reader.open(traceFileName().c_str()))
+            throw cRuntimeError("Cannot open the arrival trace %s", traceFileName().c_str());
+
+        // The first arrival of the trace is measured from time 0.
+        double first_time;
+        if (nextInterarrivalTime(first_time))
+            scheduleAt( simTime() + first_time, generation_event_message );
+
+        return;
+    }
+
     scheduleAt( simTime(), generation_event_message );
 }
 
+/**
+ * It stores into the packet the time at which it has been generated.
+ * In the slot-time domain the time is split, in integer arithmetic, into the slot of the generation
+ * and the fraction of it already elapsed: the slots are counted from time 0, as the slot beeps.
+ */
+void Generator::stampGeneration(Packet* p)
+{
+    if (!slot_time_domain) {
+        p->setGeneration_time(SIMTIME_DBL(simTime()));           // Store the time at which the packet has been generated.
+        p->setTransmission_time(0);                              // Prepare the time at which the packet will be sent by the transmitter.
+        return;
+    }
+
+    int64_t now = SIMTIME_RAW(simTime());
+
+    p->setGeneration_slot(now / slot_time_raw);
+    p->setGeneration_offset((now % slot_time_raw) / (double) slot_time_raw);
+    p->setTransmission_slot(0);
+}
+
+/**
+ * A packet generated at the current time may not have been queued yet: the next arrival is now.
+ */
+bool Generator::nextArrivalTime(simtime_t& time)
+{
+    if (last_generation_time == simTime()) {
+        time = simTime();
+        return true;
+    }
+
+    if (!generation_event_message->isScheduled())
+        return false;
+
+    time = generation_event_message->getArrivalTime();
+    return true;
+}
+
 void Generator::finish() {
 
     cancelAndDelete( generation_event_message );
+    memoryReleased(MEMORY_CONTROL_MESSAGES, sizeof(cMessage));
+
+    trace_writer.close();
+    trace_reader.close();
+}
+
+/**
+ * The name of the trace of this generator: the first "%d" is replaced by its index; without "%d"
+ * the index is added as "-<index>" before the extension.
+ */
+std::string Generator::traceFileName() {
+
+    std::string file_name = par("arrival_trace_file").stdstringValue();
+    std::string index = std::to_string(getIndex());
+
+    size_t token = file_name.find("%d");
+    if (token != std::string::npos)
+        return file_name.replace(token, 2, index);
+
+    size_t extension = file_name.rfind('.');
+    if (extension == std::string::npos || file_name.find('/', extension) != std::string::npos)
+        extension = file_name.size();
+
+    return file_name.insert(extension, "-" + index);
+}
+
+/**
+ * Time to wait before the next arrival: it is read from the trace in replay mode,
+ * otherwise it is calculated with an exponential distribution.
+ * It returns false when the trace is over.
+ */
+bool Generator::nextInterarrivalTime(double& time) {
+
+    if (trace_mode == TRACE_REPLAY) {
+
+        if (trace_reader.next(time))
+            return true;
+
+        if (trace_reader.isCorrupted())
+            throw cRuntimeError("The arrival trace %s is corrupted", traceFileName().c_str());
+
+        return false;
+    }
+
+    double mean_time = par("exponential_send_mean_time").doubleValue();
+    time = random_streams.exponential(ARRIVAL_STREAM, mean_time);
+
+    return true;
 }
 
 
 void Generator::handleMessage(cMessage *msg)
 {
+    PROFILE_HANDLER(PROFILE_GENERATOR);
+
     //If the arrived msg is equal to timer message -> OK, otherwise BLOCKS ALL!
     ASSERT( msg == generation_event_message );
 
     // Cancel event to free memory
     cancelEvent(msg);
 
-    // Time to wait before generating and sending next packet, calculated with an exponential distribution.
-    double mean_time = par("exponential_send_mean_time").doubleValue();
-    double exp_time = exponential(mean_time);
+    // Record the arrival.
+    if (trace_mode == TRACE_RECORD)
+        trace_writer.append(SIMTIME_DBL(simTime()));
+
 
+    last_generation_time = simTime();
 
     packetToSend = new Packet(packetName);
-    packetToSend->setGeneration_time(SIMTIME_DBL(simTime()));           // Store the time at which the packet has been generated.
-    packetToSend->setTransmission_time(0);                              // Prepare the time at which the packet will be sent by the transmitter.
+    memoryAllocated(MEMORY_PENDING_PACKETS, sizeof(Packet));
+    stampGeneration(packetToSend);
 
 
     send( packetToSend, "out" );
 
-    // Create next packet's generation event.
-    scheduleAt( simTime() + exp_time, generation_event_message );
+    // Create next packet's generation event: in replay mode the generator stops when the trace is over.
+    double next_time;
+    if (nextInterarrivalTime(next_time))
+        scheduleAt( simTime() + next_time, generation_event_message );
 
 }
@@ -19,6 +19,10 @@
 #include <omnetpp.h>
 #include <Utility>
 #include "Packet_m.h"
+#include "Profiling.h"
+#include "RandomStreams.h"
+#include "ArrivalTrace.h"
+#include "MemoryAccounting.h"
 
 using namespace omnetpp;
 
@@ -30,15 +34,35 @@ class Generator : public cSimpleModule
    private:
    cMessage *generation_event_message;
    Packet* packetToSend;
+   RandomStreams random_streams;
+
+   // Slot-time domain: the packet is stamped with the slot of its generation and the offset inside it.
+   bool slot_time_domain;
+   int64_t slot_time_raw;       //  slot time in simtime_t units
+
+   // Time of the last generation: its packet may still be on the way to the transmitter.
+   simtime_t last_generation_time;
+
+   // Arrival trace: "none", "record" the generated arrivals or "replay" them from a file.
+   enum { TRACE_NONE, TRACE_RECORD, TRACE_REPLAY } trace_mode;
+   ArrivalTraceWriter trace_writer;
+   ArrivalTraceReader trace_reader;
 
    public:
        //Generator();
        //virtual ~Generator();
 
+       // Time of the next packet to reach the transmitter; false if the generator has stopped.
+       bool nextArrivalTime(simtime_t& time);
+
    protected:
        virtual void initialize();
        virtual void handleMessage(cMessage *msg);
        virtual void finish();
+
+       std::string traceFileName();
+       bool nextInterarrivalTime(double& time);
+       void stampGeneration(Packet* p);
 };
 
 #endif
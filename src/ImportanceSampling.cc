@@ -0,0 +1,155 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#include "ImportanceSampling.h"
+
+#include <math.h>
+#include <stdio.h>
+
+/**
+ * With n = 2^X - 1 values and a = log(tilt) / (n - 1), P'(w) = e^(a(w-1)) / Z with Z = (e^(an) - 1) / (e^a - 1):
+ * P'(n) / P'(1) = e^(a(n-1)) = tilt, whatever X is. With a single value there is nothing to tilt.
+ * The inverse of the cumulative distribution and log Z are computed without overflow.
+ */
+int tiltedBackoff(double u, int exponent, double tilt, double& likelihood_ratio) {
+
+    double n = pow(2, exponent) - 1;
+
+    if (n <= 1)
+        return 1;
+
+    double a = log(tilt) / (n - 1);
+
+    if (fabs(a) < 1e-12)
+        return 1 + (int) (u * n);
+
+    double offset, log_z;
+
+    if (a > 0) {
+        offset = (a * n + log(u + (1 - u) * exp(-a * n))) / a;
+        log_z = a * n + log(-expm1(-a * n)) - log(expm1(a));
+    }
+    else {
+        offset = log1p(u * expm1(a * n)) / a;
+        log_z = log(-expm1(a * n)) - log(-expm1(a));
+    }
+
+    double w = floor(offset);
+    if (w > n - 1)
+        w = n - 1;
+    if (w < 0)
+        w = 0;
+
+    likelihood_ratio *= exp(log_z - a * w - log(n));
+
+    return 1 + (int) w;
+}
+
+ImportanceEstimator *ImportanceEstimator::tagged = 0;
+
+ImportanceEstimator::ImportanceEstimator() {
+
+    probes = 0;
+    weight_sum = 0;
+    undelivered = 0;
+}
+
+void ImportanceEstimator::configure(const char *delays, const char *collisions) {
+
+    delay_thresholds = cStringTokenizer(delays).asDoubleVector();
+    collision_thresholds = cStringTokenizer(collisions).asDoubleVector();
+
+    delay_sum.assign(delay_thresholds.size(), 0);
+    delay_squares.assign(delay_thresholds.size(), 0);
+    collision_sum.assign(collision_thresholds.size(), 0);
+    collision_squares.assign(collision_thresholds.size(), 0);
+
+    probes = 0;
+    weight_sum = 0;
+    undelivered = 0;
+
+    tagged = this;
+}
+
+void ImportanceEstimator::collect(double delay, int collisions, double likelihood_ratio) {
+
+    probes++;
+    weight_sum += likelihood_ratio;
+
+    for (size_t i = 0; i < delay_thresholds.size(); i++) {
+        if (delay > delay_thresholds[i]) {
+            delay_sum[i] += likelihood_ratio;
+            delay_squares[i] += likelihood_ratio * likelihood_ratio;
+        }
+    }
+
+    for (size_t i = 0; i < collision_thresholds.size(); i++) {
+        if (collisions >= collision_thresholds[i]) {
+            collision_sum[i] += likelihood_ratio;
+            collision_squares[i] += likelihood_ratio * likelihood_ratio;
+        }
+    }
+}
+
+/**
+ * A probe still queued at the end of the run: its delay is not known yet, so it counts as exceeding every
+ * delay threshold, and its collisions so far as reached. Leaving it out would bias the tails low, since the
+ * probes that are late at the end are the long ones; counting it biases them high by at most one probe.
+ */
+void ImportanceEstimator::collectUndelivered(int collisions, double likelihood_ratio) {
+
+    collect(INFINITY, collisions, likelihood_ratio);
+    undelivered++;
+}
+
+void ImportanceEstimator::record(cComponent *owner) {
+
+    if (tagged == this)
+        tagged = 0;
+
+    char name[64];
+
+    for (size_t i = 0; i < delay_thresholds.size(); i++) {
+        sprintf(name, "is_delay_exceeds_%gs", delay_thresholds[i]);
+        recordTail(owner, name, delay_sum[i], delay_squares[i]);
+    }
+
+    for (size_t i = 0; i < collision_thresholds.size(); i++) {
+        sprintf(name, "is_collisions_at_least_%g", collision_thresholds[i]);
+        recordTail(owner, name, collision_sum[i], collision_squares[i]);
+    }
+
+    // The mean likelihood ratio should stay close to 1: far from it, the bias is too strong.
+    owner->recordScalar("is_probes", probes);
+    owner->recordScalar("is_undelivered_probes", undelivered);
+    owner->recordScalar("is_mean_likelihood_ratio", (probes > 0) ? weight_sum / probes : 0);
+}
+
+/**
+ * Estimate: the mean of the weighted indicator over the probes; confidence interval from its sample variance.
+ */
+void ImportanceEstimator::recordTail(cComponent *owner, const char *name, double sum, double squares) {
+
+    double estimate = (probes > 0) ? sum / probes : 0;
+    double ci = 0;
+
+    if (probes > 1) {
+        double variance = (squares - probes * estimate * estimate) / (probes - 1);
+        ci = 1.96 * sqrt(variance > 0 ? variance : 0) / sqrt(probes);
+    }
+
+    owner->recordScalar((std::string(name) + ":estimate").c_str(), estimate);
+    owner->recordScalar((std::string(name) + ":ci95").c_str(), ci);
+}
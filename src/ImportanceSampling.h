@@ -0,0 +1,77 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#ifndef __SRAWN_IMPORTANCESAMPLING_H_
+#define __SRAWN_IMPORTANCESAMPLING_H_
+
+#include <omnetpp.h>
+#include <vector>
+
+using namespace omnetpp;
+
+/*
+ * Importance sampling of the tail of the delay and of the collisions of a packet.
+ *
+ * The tagged transmitter biases the draws it makes for a probe packet ( a packet that found its queue
+ * empty ): the bernoullian test uses a larger probability and the backoff is drawn from a tilted
+ * distribution on 1 .. 2^(X+1)-1, exponential in w, whose last value is "tilt" times as likely as the
+ * first one ( tilt > 1 favours long backoffs ). Each biased draw multiplies the
+ * likelihood ratio of the packet by P(draw) / P'(draw); the receiver weights the probe with it.
+ */
+
+/**
+ * It draws a tilted backoff of exponent X from the uniform number u in [0,1) and multiplies
+ * likelihood_ratio by the ratio of the uniform probability to the tilted one.
+ */
+int tiltedBackoff(double u, int exponent, double tilt, double& likelihood_ratio);
+
+/**
+ * Weighted estimates of P(delay > x) and P(collisions >= m) over the probe packets, with their
+ * 95% confidence intervals.
+ */
+class ImportanceEstimator
+{
+private:
+    std::vector<double> delay_thresholds;
+    std::vector<double> collision_thresholds;
+
+    // Sums of the weighted indicators and of their squares for each threshold.
+    std::vector<double> delay_sum, delay_squares;
+    std::vector<double> collision_sum, collision_squares;
+
+    double probes;
+    double weight_sum;
+    double undelivered;
+
+public:
+    // The estimator of the receiver of the tagged transmitter, from configure() to record().
+    static ImportanceEstimator *tagged;
+
+    ImportanceEstimator();
+
+    // Thresholds: lists of numbers separated by spaces ( delays in seconds, collision numbers ).
+    void configure(const char *delays, const char *collisions);
+
+    void collect(double delay, int collisions, double likelihood_ratio);
+    void collectUndelivered(int collisions, double likelihood_ratio);
+
+    // Scalars: is_delay_exceeds_<x>s and is_collisions_at_least_<m>, as :estimate and :ci95.
+    void record(cComponent *owner);
+
+protected:
+    void recordTail(cComponent *owner, const char *name, double sum, double squares);
+};
+
+#endif
@@ -0,0 +1,205 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#include "LiveMetrics.h"
+
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+LiveMetrics *LiveMetrics::active = 0;
+
+LiveMetrics::LiveMetrics() {
+
+    snapshot = 0;
+    queued_packets = 0;
+    delivered_packets = 0;
+    memset(delay_histogram, 0, sizeof(delay_histogram));
+    start_wall_time = last_wall_time = 0;
+    last_events = 0;
+}
+
+LiveMetrics::~LiveMetrics() {
+
+    close();
+}
+
+/**
+ * The pattern is user input: it is never used as a format, the process id is spliced in explicitly.
+ */
+bool LiveMetrics::segmentName(const char *pattern, std::string& name) {
+
+    name = pattern;
+
+    size_t token = name.find("%d");
+    if (token != std::string::npos)
+        name.replace(token, 2, std::to_string((int) getpid()));
+
+    return name.find('%') == std::string::npos;
+}
+
+/**
+ * It creates the shared-memory segment: the first "%d" in the name is replaced by the process id.
+ */
+bool LiveMetrics::open(const char *name_pattern, int transmitter_size, int channel_size) {
+
+    close();
+
+    if (!segmentName(name_pattern, name))
+        return false;
+
+    int fd = shm_open(name.c_str(), O_CREAT | O_RDWR, 0644);
+    if (fd < 0)
+        return false;
+
+    if (ftruncate(fd, sizeof(LiveMetricsSnapshot)) != 0) {
+        ::close(fd);
+        return false;
+    }
+
+    void *map = mmap(0, sizeof(LiveMetricsSnapshot), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+
+    if (map == MAP_FAILED)
+        return false;
+
+    snapshot = (LiveMetricsSnapshot*) map;
+    memset(snapshot, 0, sizeof(LiveMetricsSnapshot));
+    snapshot->magic = LIVE_METRICS_MAGIC;
+    snapshot->version = LIVE_METRICS_VERSION;
+    snapshot->pid = getpid();
+    snapshot->transmitter_size = transmitter_size;
+    snapshot->channel_size = channel_size;
+
+    queued_packets = 0;
+    delivered_packets = 0;
+    memset(delay_histogram, 0, sizeof(delay_histogram));
+    start_wall_time = last_wall_time = wallTime();
+    last_events = 0;
+
+    active = this;
+
+    return true;
+}
+
+void LiveMetrics::remove() {
+
+    if (snapshot != 0)
+        shm_unlink(name.c_str());
+}
+
+/**
+ * The segment is unmapped but not removed ( see remove() ): a watchdog can still read the final snapshot.
+ */
+void LiveMetrics::close() {
+
+    if (active == this)
+        active = 0;
+
+    if (snapshot != 0)
+        munmap(snapshot, sizeof(LiveMetricsSnapshot));
+
+    snapshot = 0;
+}
+
+void LiveMetrics::publish(double sim_time, uint64_t slot_counter, uint64_t events, double throughput, int transmitter_size) {
+
+    if (snapshot == 0)
+        return;
+
+    double now = wallTime();
+    double elapsed = now - last_wall_time;
+
+    // Seqlock: odd sequence number while the snapshot is being written.
+    snapshot->sequence++;
+    __sync_synchronize();
+
+    snapshot->sim_time = sim_time;
+    snapshot->slot_counter = slot_counter;
+    snapshot->events = events;
+    snapshot->events_per_second = (elapsed > 0) ? (events - last_events) / elapsed : 0;
+    snapshot->wall_time = now - start_wall_time;
+    snapshot->throughput = throughput;
+    snapshot->mean_queue_length = queued_packets / (double) transmitter_size;
+    snapshot->delivered_packets = delivered_packets;
+    snapshot->delay_p50 = delayPercentile(0.50);
+    snapshot->delay_p90 = delayPercentile(0.90);
+    snapshot->delay_p99 = delayPercentile(0.99);
+
+    __sync_synchronize();
+    snapshot->sequence++;
+
+    // New window for the delays.
+    delivered_packets = 0;
+    memset(delay_histogram, 0, sizeof(delay_histogram));
+    last_wall_time = now;
+    last_events = events;
+}
+
+void LiveMetrics::markFinished() {
+
+    if (snapshot == 0)
+        return;
+
+    snapshot->sequence++;
+    __sync_synchronize();
+    snapshot->finished = 1;
+    __sync_synchronize();
+    snapshot->sequence++;
+}
+
+void LiveMetrics::collectDelay(double delay) {
+
+    int bin = 0;
+    if (delay > DELAY_HISTOGRAM_MIN)
+        bin = (int) (log2(delay / DELAY_HISTOGRAM_MIN) * DELAY_HISTOGRAM_BINS_PER_OCTAVE) + 1;
+    if (bin >= DELAY_HISTOGRAM_BINS)
+        bin = DELAY_HISTOGRAM_BINS - 1;
+
+    delay_histogram[bin]++;
+    delivered_packets++;
+}
+
+/**
+ * It returns the upper bound of the bin holding the q-quantile.
+ */
+double LiveMetrics::delayPercentile(double q) {
+
+    if (delivered_packets == 0)
+        return 0;
+
+    uint64_t rank = (uint64_t) ceil(q * delivered_packets);
+    uint64_t cumulative = 0;
+
+    for (int bin = 0; bin < DELAY_HISTOGRAM_BINS; bin++) {
+
+        cumulative += delay_histogram[bin];
+        if (cumulative >= rank)
+            return DELAY_HISTOGRAM_MIN * pow(2, bin / (double) DELAY_HISTOGRAM_BINS_PER_OCTAVE);
+    }
+
+    return DELAY_HISTOGRAM_MIN * pow(2, DELAY_HISTOGRAM_BINS / (double) DELAY_HISTOGRAM_BINS_PER_OCTAVE);
+}
+
+double LiveMetrics::wallTime() {
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
@@ -0,0 +1,108 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#ifndef __SRAWN_LIVEMETRICS_H_
+#define __SRAWN_LIVEMETRICS_H_
+
+#include <stdint.h>
+#include <string>
+
+/*
+ * Live metrics: the chosen one publishes aggregate statistics into a POSIX shared-memory
+ * segment every K slots, so that a dashboard or a watchdog can follow a long run.
+ * Readers must use the sequence number as a seqlock: an odd value means that an update
+ * is in progress, and a snapshot is consistent only if the value did not change while copying it.
+ */
+
+#define LIVE_METRICS_MAGIC 0x5352574c          //  "SRWL"
+#define LIVE_METRICS_VERSION 1
+
+// Delay histogram: logarithmic bins, from DELAY_HISTOGRAM_MIN seconds on.
+
+#define DELAY_HISTOGRAM_MIN 1e-4
+#define DELAY_HISTOGRAM_BINS_PER_OCTAVE 8
+#define DELAY_HISTOGRAM_BINS 256
+
+struct LiveMetricsSnapshot {
+    uint32_t magic;
+    uint32_t version;
+    volatile uint64_t sequence;         //  Seqlock: odd while the writer is updating the snapshot
+
+    int32_t pid;                        //  Process running the simulation
+    int32_t transmitter_size;
+    int32_t channel_size;
+    int32_t finished;                   //  1 when the simulation is over
+
+    double sim_time;                    //  [ s ]
+    uint64_t slot_counter;
+    uint64_t events;
+    double events_per_second;           //  Since the previous update
+    double wall_time;                   //  Since the beginning of the run [ s ]
+
+    double throughput;                  //  Successful slots per slot, summed over all the channels
+    double mean_queue_length;           //  Packets queued per transmitter
+    uint64_t delivered_packets;         //  Since the previous update
+    double delay_p50;                   //  Delay percentiles since the previous update [ s ]
+    double delay_p90;
+    double delay_p99;
+};
+
+/**
+ * Writer side: a process-wide singleton, enabled by the chosen one.
+ * Transmitters and Receivers feed it through the static inline functions, which cost nothing when it is disabled.
+ */
+class LiveMetrics
+{
+private:
+    static LiveMetrics *active;
+
+    std::string name;
+    LiveMetricsSnapshot *snapshot;
+
+    uint64_t queued_packets;
+    uint64_t delivered_packets;
+    uint64_t delay_histogram[DELAY_HISTOGRAM_BINS];
+
+    double start_wall_time;
+    double last_wall_time;
+    uint64_t last_events;
+
+public:
+    LiveMetrics();
+    ~LiveMetrics();
+
+    bool open(const char *name, int transmitter_size, int channel_size);
+    // Name of the segment: the first "%d" of the pattern becomes the process id. It fails on any other '%'.
+    static bool segmentName(const char *pattern, std::string& name);
+    // It removes the segment name: the readers that have mapped it still see the last snapshot.
+    void remove();
+    void close();
+
+    // It publishes a new snapshot and starts a new window for the delay percentiles.
+    void publish(double sim_time, uint64_t slot_counter, uint64_t events, double throughput, int transmitter_size);
+    void markFinished();
+
+    static void packetQueued() { if (active) active->queued_packets++; }
+    static void packetDequeued() { if (active) active->queued_packets--; }
+    static void packetDelivered(double delay) { if (active) active->collectDelay(delay); }
+
+    static double wallTime();
+
+protected:
+    void collectDelay(double delay);
+    double delayPercentile(double q);
+};
+
+#endif
@@ -0,0 +1,107 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#include "Medium.h"
+#include "MemoryAccounting.h"
+
+Define_Module(Medium);
+
+Medium::Medium() {
+
+    decisionBeep = 0;
+    cluster = 0;
+    channel_size = 0;
+    slot_counter = 0;
+}
+
+Medium::~Medium() {
+
+}
+
+void Medium::initialize() {
+
+    cluster = check_and_cast<TransmitterCluster*>(getParentModule());
+    channel_size = (int) cluster->par("channel_size");
+    attempts.assign(channel_size, 0);
+
+    simtime_t slot_time = cluster->par("slot_time").doubleValue();
+    simtime_t cd_time = cluster->par("collision_detection_time").doubleValue();
+    simtime_t delay = cluster->par("medium_delay").doubleValue();
+
+    // The verdict must reach the transmitters before their collision detection.
+    if (delay <= 0 || 3 * delay >= cd_time)
+        throw cRuntimeError("medium_delay must be positive and less than collision_detection_time / 3");
+
+    // The decision of slot k comes after the attempts of slot k ( sent at k * slot_time ) have arrived.
+    decisionBeep = new cMessage("decision beep");
+    memoryAllocated(MEMORY_CONTROL_MESSAGES, sizeof(cMessage));
+    scheduleAt(slot_time + 2 * delay, decisionBeep);
+}
+
+void Medium::handleMessage(cMessage *msg) {
+
+    if (msg == decisionBeep) {
+
+        decide();
+
+        simtime_t slot_time = cluster->par("slot_time").doubleValue();
+        scheduleAt(simTime() + slot_time, decisionBeep);
+        return;
+    }
+
+    // An attempt: its kind is the channel.
+    int channel = msg->getKind();
+
+    attempts[channel]++;
+    senders.push_back(std::make_pair(msg->getArrivalGate()->getIndex(), channel));
+
+    delete msg;
+    memoryReleased(MEMORY_CONTROL_MESSAGES, sizeof(cMessage));
+}
+
+/**
+ * End of the slot for the medium: every transmitter that made an attempt gets the number of
+ * transmissions on its channel, the channels with one transmission count a success and the
+ * throughput is emitted, as the chosen one does with the shared channel matrix.
+ */
+void Medium::decide() {
+
+    slot_counter++;
+
+    for (size_t i = 0; i < senders.size(); i++) {
+
+        cMessage *verdict = new cMessage(MEDIUM_VERDICT_NAME, attempts[senders[i].second]);
+        send(verdict, "out", senders[i].first);
+        memoryAllocated(MEMORY_CONTROL_MESSAGES, sizeof(cMessage));
+    }
+
+    for (int j = 0; j < channel_size; j++) {
+
+        if (attempts[j] == 1)
+            cluster->channel_successful_slot_counter_array[j]++;
+    }
+
+    cluster->channelThroughput(slot_counter, simTime() > getSimulation()->getWarmupPeriod());
+
+    attempts.assign(channel_size, 0);
+    senders.clear();
+}
+
+void Medium::finish() {
+
+    cancelAndDelete(decisionBeep);
+    memoryReleased(MEMORY_CONTROL_MESSAGES, sizeof(cMessage));
+    decisionBeep = 0;
+}
@@ -0,0 +1,60 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#ifndef __SRAWN_MEDIUM_H_
+#define __SRAWN_MEDIUM_H_
+
+#include <omnetpp.h>
+#include <vector>
+
+#include "TransmitterCluster.h"
+
+using namespace omnetpp;
+
+// Message kinds: an attempt carries its channel, a verdict the number of transmissions on it.
+
+#define MEDIUM_ATTEMPT_NAME "attempt"
+#define MEDIUM_VERDICT_NAME "verdict"
+
+/**
+ * The medium of the message-based mode ( message_medium = true ): it gathers the attempts of a slot,
+ * answers every transmitter that made one, and keeps the successes of each channel in place of the
+ * transmitters, which may be in other partitions.
+ */
+class Medium : public cSimpleModule
+{
+private:
+    cMessage *decisionBeep;
+    TransmitterCluster *cluster;
+
+    int channel_size;
+    int slot_counter;
+
+    std::vector<int> attempts;                  //  Transmissions on each channel in this slot
+    std::vector<std::pair<int, int> > senders;  //  Gate index and channel of each attempt
+
+public:
+    Medium();
+    virtual ~Medium();
+
+protected:
+    virtual void initialize();
+    virtual void handleMessage(cMessage *msg);
+    virtual void finish();
+
+    void decide();
+};
+
+#endif
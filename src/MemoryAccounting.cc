@@ -0,0 +1,153 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#include "MemoryAccounting.h"
+
+#include <stdio.h>
+#include <string.h>
+
+thread_local MemoryAccountingData memory_accounting;
+
+static const char *category_names[MEMORY_CATEGORY_NUMBER] = {
+    "queued_packets", "pending_packets", "control_messages", "fes", "gates", "result_recorders", "shared_state"
+};
+
+const char *memoryCategoryName(int category) {
+
+    return category_names[category];
+}
+
+/**
+ * Cmdenv can run several simulations in the same process: the data are cleared at the beginning of each one.
+ */
+void resetMemoryAccounting() {
+
+    memset(&memory_accounting, 0, sizeof(memory_accounting));
+}
+
+void setMemoryAccount(int category, int64_t objects, int64_t bytes) {
+
+    MemoryAccount& account = memory_accounting.accounts[category];
+
+    account.objects = objects;
+    account.bytes = bytes;
+
+    if (account.bytes > account.peak_bytes) {
+        account.peak_objects = account.objects;
+        account.peak_bytes = account.bytes;
+    }
+}
+
+/**
+ * Gates, channel objects and signal listeners of every component: they are created with the network.
+ */
+static void measureStaticCategories(cSimulation *simulation) {
+
+    int64_t gates = 0, channels = 0, listeners = 0;
+
+    for (int id = 1; id <= simulation->getLastComponentId(); id++) {
+
+        cComponent *component = simulation->getComponent(id);
+        if (!component)
+            continue;
+
+        std::vector<simsignal_t> signals = component->getLocalListenedSignals();
+        for (size_t s = 0; s < signals.size(); s++)
+            listeners += component->getLocalSignalListeners(signals[s]).size();
+
+        cModule *module = dynamic_cast<cModule*>(component);
+        if (!module)
+            continue;
+
+        for (cModule::GateIterator it(module); !it.end(); it++) {
+
+            gates++;
+            if ((*it)->getChannel())
+                channels++;
+        }
+    }
+
+    setMemoryAccount(MEMORY_GATES, gates + channels, gates * sizeof(cGate) + channels * sizeof(cDelayChannel));
+    setMemoryAccount(MEMORY_RESULT_RECORDERS, listeners, listeners * sizeof(cResultListener));
+
+    memory_accounting.static_measured = true;
+}
+
+int64_t sampleMemoryAccounting(cSimulation *simulation) {
+
+    if (!memory_accounting.static_measured)
+        measureStaticCategories(simulation);
+
+    int fes_length = simulation->getFES()->getLength();
+    setMemoryAccount(MEMORY_FES, fes_length, fes_length * sizeof(void*));
+
+    int64_t total = 0;
+    for (int c = 0; c < MEMORY_CATEGORY_NUMBER; c++)
+        total += memory_accounting.accounts[c].bytes;
+
+    if (total > memory_accounting.sampled_peak_total_bytes)
+        memory_accounting.sampled_peak_total_bytes = total;
+
+    return total;
+}
+
+/**
+ * Peak resident memory of the process ( Linux ): -1 if it is not available.
+ */
+static int64_t processPeakResidentBytes() {
+
+    FILE *status = fopen("/proc/self/status", "r");
+    if (!status)
+        return -1;
+
+    char line[256];
+    long kilobytes = -1;
+
+    while (fgets(line, sizeof(line), status))
+        if (sscanf(line, "VmHWM: %ld kB", &kilobytes) == 1)
+            break;
+
+    fclose(status);
+
+    return kilobytes < 0 ? -1 : (int64_t) kilobytes * 1024;
+}
+
+void recordMemoryScalars(cComponent *owner) {
+
+    char name[64];
+
+    sampleMemoryAccounting(owner->getSimulation());
+
+    for (int c = 0; c < MEMORY_CATEGORY_NUMBER; c++) {
+
+        const MemoryAccount& account = memory_accounting.accounts[c];
+
+        sprintf(name, "memory_%s_objects", category_names[c]);
+        owner->recordScalar(name, account.objects);
+        sprintf(name, "memory_%s_bytes", category_names[c]);
+        owner->recordScalar(name, account.bytes, "B");
+        sprintf(name, "memory_%s_peak_objects", category_names[c]);
+        owner->recordScalar(name, account.peak_objects);
+        sprintf(name, "memory_%s_peak_bytes", category_names[c]);
+        owner->recordScalar(name, account.peak_bytes, "B");
+    }
+
+    // The peaks of the categories are exact; the one of the total is taken over the samples only.
+    owner->recordScalar("memory_total_sampled_peak_bytes", memory_accounting.sampled_peak_total_bytes, "B");
+
+    int64_t peak_rss = processPeakResidentBytes();
+    if (peak_rss >= 0)
+        owner->recordScalar("memory_process_peak_rss", peak_rss, "B");
+}
@@ -0,0 +1,109 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#ifndef __SRAWN_MEMORYACCOUNTING_H_
+#define __SRAWN_MEMORYACCOUNTING_H_
+
+#include <omnetpp.h>
+#include <stdint.h>
+
+#include "Packet_m.h"
+
+using namespace omnetpp;
+
+/*
+ * Memory accounting: live objects and bytes of each category of the model. The hooks of the modules
+ * count the objects that come and go ( packets, timers, medium messages ); the rest is measured
+ * when it is sampled. The bytes are sizeof() estimates of the objects, without the overhead of the allocator.
+ * The data are thread-local like the instrumentation: the transmitter cluster clears them at the beginning
+ * of each run, and the chosen one samples them every memory_sample_period slots and records them at finish().
+ */
+
+enum MemoryCategory {
+    MEMORY_QUEUED_PACKETS = 0,  //  Packets in the cQueues of the transmitters, with their queue nodes
+    MEMORY_PENDING_PACKETS,     //  Packets on their way: generator to transmitter, transmitter to receiver
+    MEMORY_CONTROL_MESSAGES,    //  Self-messages of the modules, attempts and verdicts of the medium
+    MEMORY_FES,                 //  Entries of the future event set ( the events are counted above )
+    MEMORY_GATES,               //  Gates and channel objects of the connections
+    MEMORY_RESULT_RECORDERS,    //  Listeners of the signals ( the vector buffers are limited by output-vectors-memory-limit )
+    MEMORY_SHARED_STATE,        //  Arrays of the transmitter cluster
+    MEMORY_CATEGORY_NUMBER
+};
+
+struct MemoryAccount {
+    int64_t objects;
+    int64_t bytes;
+    int64_t peak_objects;
+    int64_t peak_bytes;
+};
+
+struct MemoryAccountingData {
+    MemoryAccount accounts[MEMORY_CATEGORY_NUMBER];
+    int64_t sampled_peak_total_bytes;   //  Largest total seen by sampleMemoryAccounting(): the FES is only measured there
+    bool static_measured;       //  Gates and recorders do not change after the initialization
+};
+
+extern thread_local MemoryAccountingData memory_accounting;
+
+// Bytes of a packet in a cQueue: the object and the node of the list.
+#define MEMORY_QUEUE_NODE_BYTES (3 * sizeof(void*))
+
+inline void memoryAllocated(int category, int64_t bytes) {
+
+    MemoryAccount& account = memory_accounting.accounts[category];
+
+    account.objects++;
+    account.bytes += bytes;
+
+    if (account.bytes > account.peak_bytes) {
+        account.peak_objects = account.objects;
+        account.peak_bytes = account.bytes;
+    }
+}
+
+inline void memoryReleased(int category, int64_t bytes) {
+
+    MemoryAccount& account = memory_accounting.accounts[category];
+
+    account.objects--;
+    account.bytes -= bytes;
+}
+
+// A packet enters or leaves the queue of a transmitter.
+inline void memoryPacketQueued() {
+
+    memoryReleased(MEMORY_PENDING_PACKETS, sizeof(Packet));
+    memoryAllocated(MEMORY_QUEUED_PACKETS, sizeof(Packet) + MEMORY_QUEUE_NODE_BYTES);
+}
+
+inline void memoryPacketDequeued() {
+
+    memoryReleased(MEMORY_QUEUED_PACKETS, sizeof(Packet) + MEMORY_QUEUE_NODE_BYTES);
+    memoryAllocated(MEMORY_PENDING_PACKETS, sizeof(Packet));
+}
+
+void resetMemoryAccounting();
+void setMemoryAccount(int category, int64_t objects, int64_t bytes);
+
+/**
+ * It measures the categories that are not counted by the hooks ( FES, gates, recorders ) and
+ * the total: the chosen one calls it every memory_sample_period slots and at finish().
+ */
+int64_t sampleMemoryAccounting(cSimulation *simulation);
+
+const char *memoryCategoryName(int category);
+void recordMemoryScalars(cComponent *owner);
+
+#endif
@@ -167,6 +167,12 @@ Packet::Packet(const char *name, int kind) : ::omnetpp::cMessage(name,kind)
 {
     this->generation_time = 0;
     this->transmission_time = 0;
+    this->generation_slot = 0;
+    this->generation_offset = 0;
+    this->transmission_slot = 0;
+    this->importance_probe = false;
+    this->likelihood_ratio = 1;
+    this->collision_number = 0;
 }
 
 Packet::Packet(const Packet& other) : ::omnetpp::cMessage(other)
@@ -190,6 +196,12 @@ void Packet::copy(const Packet& other)
 {
     this->generation_time = other.generation_time;
     this->transmission_time = other.transmission_time;
+    this->generation_slot = other.generation_slot;
+    this->generation_offset = other.generation_offset;
+    this->transmission_slot = other.transmission_slot;
+    this->importance_probe = other.importance_probe;
+    this->likelihood_ratio = other.likelihood_ratio;
+    this->collision_number = other.collision_number;
 }
 
 void Packet::parsimPack(omnetpp::cCommBuffer *b) const
@@ -197,6 +209,12 @@ void Packet::parsimPack(omnetpp::cCommBuffer *b) const
     ::omnetpp::cMessage::parsimPack(b);
     doParsimPacking(b,this->generation_time);
     doParsimPacking(b,this->transmission_time);
+    doParsimPacking(b,this->generation_slot);
+    doParsimPacking(b,this->generation_offset);
+    doParsimPacking(b,this->transmission_slot);
+    doParsimPacking(b,this->importance_probe);
+    doParsimPacking(b,this->likelihood_ratio);
+    doParsimPacking(b,this->collision_number);
 }
 
 void Packet::parsimUnpack(omnetpp::cCommBuffer *b)
@@ -204,6 +222,12 @@ void Packet::parsimUnpack(omnetpp::cCommBuffer *b)
     ::omnetpp::cMessage::parsimUnpack(b);
     doParsimUnpacking(b,this->generation_time);
     doParsimUnpacking(b,this->transmission_time);
+    doParsimUnpacking(b,this->generation_slot);
+    doParsimUnpacking(b,this->generation_offset);
+    doParsimUnpacking(b,this->transmission_slot);
+    doParsimUnpacking(b,this->importance_probe);
+    doParsimUnpacking(b,this->likelihood_ratio);
+    doParsimUnpacking(b,this->collision_number);
 }
 
 double Packet::getGeneration_time() const
@@ -226,6 +250,66 @@ void Packet::setTransmission_time(double transmission_time)
     this->transmission_time = transmission_time;
 }
 
+int64_t Packet::getGeneration_slot() const
+{
+    return this->generation_slot;
+}
+
+void Packet::setGeneration_slot(int64_t generation_slot)
+{
+    this->generation_slot = generation_slot;
+}
+
+double Packet::getGeneration_offset() const
+{
+    return this->generation_offset;
+}
+
+void Packet::setGeneration_offset(double generation_offset)
+{
+    this->generation_offset = generation_offset;
+}
+
+int64_t Packet::getTransmission_slot() const
+{
+    return this->transmission_slot;
+}
+
+void Packet::setTransmission_slot(int64_t transmission_slot)
+{
+    this->transmission_slot = transmission_slot;
+}
+
+bool Packet::getImportance_probe() const
+{
+    return this->importance_probe;
+}
+
+void Packet::setImportance_probe(bool importance_probe)
+{
+    this->importance_probe = importance_probe;
+}
+
+double Packet::getLikelihood_ratio() const
+{
+    return this->likelihood_ratio;
+}
+
+void Packet::setLikelihood_ratio(double likelihood_ratio)
+{
+    this->likelihood_ratio = likelihood_ratio;
+}
+
+int Packet::getCollision_number() const
+{
+    return this->collision_number;
+}
+
+void Packet::setCollision_number(int collision_number)
+{
+    this->collision_number = collision_number;
+}
+
 class PacketDescriptor : public omnetpp::cClassDescriptor
 {
   private:
@@ -290,7 +374,7 @@ const char *PacketDescriptor::getProperty(const char *propertyname) const
 int PacketDescriptor::getFieldCount() const
 {
     omnetpp::cClassDescriptor *basedesc = getBaseClassDescriptor();
-    return basedesc ? 2+basedesc->getFieldCount() : 2;
+    return basedesc ? 8+basedesc->getFieldCount() : 8;
 }
 
 unsigned int PacketDescriptor::getFieldTypeFlags(int field) const
@@ -304,8 +388,14 @@ unsigned int PacketDescriptor::getFieldTypeFlags(int field) const
     static unsigned int fieldTypeFlags[] = {
         FD_ISEDITABLE,
         FD_ISEDITABLE,
+        FD_ISEDITABLE,
+        FD_ISEDITABLE,
+        FD_ISEDITABLE,
+        FD_ISEDITABLE,
+        FD_ISEDITABLE,
+        FD_ISEDITABLE,
     };
-    return (field>=0 && field<2) ? fieldTypeFlags[field] : 0;
+    return (field>=0 && field<8) ? fieldTypeFlags[field] : 0;
 }
 
 const char *PacketDescriptor::getFieldName(int field) const
@@ -319,8 +409,14 @@ const char *PacketDescriptor::getFieldName(int field) const
     static const char *fieldNames[] = {
         "generation_time",
         "transmission_time",
+        "generation_slot",
+        "generation_offset",
+        "transmission_slot",
+        "importance_probe",
+        "likelihood_ratio",
+        "collision_number",
     };
-    return (field>=0 && field<2) ? fieldNames[field] : nullptr;
+    return (field>=0 && field<8) ? fieldNames[field] : nullptr;
 }
 
 int PacketDescriptor::findField(const char *fieldName) const
@@ -329,6 +425,12 @@ int PacketDescriptor::findField(const char *fieldName) const
     int base = basedesc ? basedesc->getFieldCount() : 0;
     if (fieldName[0]=='g' && strcmp(fieldName, "generation_time")==0) return base+0;
     if (fieldName[0]=='t' && strcmp(fieldName, "transmission_time")==0) return base+1;
+    if (fieldName[0]=='g' && strcmp(fieldName, "generation_slot")==0) return base+2;
+    if (fieldName[0]=='g' && strcmp(fieldName, "generation_offset")==0) return base+3;
+    if (fieldName[0]=='t' && strcmp(fieldName, "transmission_slot")==0) return base+4;
+    if (fieldName[0]=='i' && strcmp(fieldName, "importance_probe")==0) return base+5;
+    if (fieldName[0]=='l' && strcmp(fieldName, "likelihood_ratio")==0) return base+6;
+    if (fieldName[0]=='c' && strcmp(fieldName, "collision_number")==0) return base+7;
     return basedesc ? basedesc->findField(fieldName) : -1;
 }
 
@@ -343,8 +445,14 @@ const char *PacketDescriptor::getFieldTypeString(int field) const
     static const char *fieldTypeStrings[] = {
         "double",
         "double",
+        "int64_t",
+        "double",
+        "int64_t",
+        "bool",
+        "double",
+        "int",
     };
-    return (field>=0 && field<2) ? fieldTypeStrings[field] : nullptr;
+    return (field>=0 && field<8) ? fieldTypeStrings[field] : nullptr;
 }
 
 const char **PacketDescriptor::getFieldPropertyNames(int field) const
@@ -399,6 +507,12 @@ std::string PacketDescriptor::getFieldValueAsString(void *object, int field, int
     switch (field) {
         case 0: return double2string(pp->getGeneration_time());
         case 1: return double2string(pp->getTransmission_time());
+        case 2: return int642string(pp->getGeneration_slot());
+        case 3: return double2string(pp->getGeneration_offset());
+        case 4: return int642string(pp->getTransmission_slot());
+        case 5: return bool2string(pp->getImportance_probe());
+        case 6: return double2string(pp->getLikelihood_ratio());
+        case 7: return long2string(pp->getCollision_number());
         default: return "";
     }
 }
@@ -415,6 +529,12 @@ bool PacketDescriptor::setFieldValueAsString(void *object, int field, int i, con
     switch (field) {
         case 0: pp->setGeneration_time(string2double(value)); return true;
         case 1: pp->setTransmission_time(string2double(value)); return true;
+        case 2: pp->setGeneration_slot(string2int64(value)); return true;
+        case 3: pp->setGeneration_offset(string2double(value)); return true;
+        case 4: pp->setTransmission_slot(string2int64(value)); return true;
+        case 5: pp->setImportance_probe(string2bool(value)); return true;
+        case 6: pp->setLikelihood_ratio(string2double(value)); return true;
+        case 7: pp->setCollision_number(string2long(value)); return true;
         default: return false;
     }
 }
@@ -22,6 +22,12 @@
  * {
  *     double generation_time;
  *     double transmission_time;
+ *     int64 generation_slot;
+ *     double generation_offset;
+ *     int64 transmission_slot;
+ *     bool importance_probe;
+ *     double likelihood_ratio = 1;
+ *     int collision_number;
  * }
  * </pre>
  */
@@ -30,6 +36,12 @@ class Packet : public ::omnetpp::cMessage
   protected:
     double generation_time;
     double transmission_time;
+    int64_t generation_slot;
+    double generation_offset;
+    int64_t transmission_slot;
+    bool importance_probe;
+    double likelihood_ratio;
+    int collision_number;
 
   private:
     void copy(const Packet& other);
@@ -52,6 +64,18 @@ class Packet : public ::omnetpp::cMessage
     virtual void setGeneration_time(double generation_time);
     virtual double getTransmission_time() const;
     virtual void setTransmission_time(double transmission_time);
+    virtual int64_t getGeneration_slot() const;
+    virtual void setGeneration_slot(int64_t generation_slot);
+    virtual double getGeneration_offset() const;
+    virtual void setGeneration_offset(double generation_offset);
+    virtual int64_t getTransmission_slot() const;
+    virtual void setTransmission_slot(int64_t transmission_slot);
+    virtual bool getImportance_probe() const;
+    virtual void setImportance_probe(bool importance_probe);
+    virtual double getLikelihood_ratio() const;
+    virtual void setLikelihood_ratio(double likelihood_ratio);
+    virtual int getCollision_number() const;
+    virtual void setCollision_number(int collision_number);
 };
 
 inline void doParsimPacking(omnetpp::cCommBuffer *b, const Packet& obj) {obj.parsimPack(b);}
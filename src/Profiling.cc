@@ -0,0 +1,58 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#include "Profiling.h"
+
+#include <string.h>
+
+thread_local ProfilingData profiling_data;
+
+static const char *handler_names[PROFILED_HANDLER_NUMBER] = {
+    "tx_beep", "tx_cd", "tx_clear", "tx_packet", "generator", "receiver"
+};
+
+static const char *counter_names[PROFILED_COUNTER_NUMBER] = {
+    "bernoulli_draws", "collisions", "backoff_slots"
+};
+
+/**
+ * Cmdenv can run several simulations in the same process: the data are cleared at the beginning of each one.
+ */
+void resetProfiling() {
+
+    memset(&profiling_data, 0, sizeof(profiling_data));
+}
+
+void recordProfilingScalars(cComponent *owner) {
+
+#ifdef SRAWN_PROFILING
+    char name[64];
+
+    for (int h = 0; h < PROFILED_HANDLER_NUMBER; h++) {
+
+        sprintf(name, "profile_%s_events", handler_names[h]);
+        owner->recordScalar(name, profiling_data.events[h]);
+
+        sprintf(name, "profile_%s_cpu_time", handler_names[h]);
+        owner->recordScalar(name, profiling_data.nanoseconds[h] * 1e-9, "s");
+    }
+
+    for (int c = 0; c < PROFILED_COUNTER_NUMBER; c++) {
+
+        sprintf(name, "profile_%s", counter_names[c]);
+        owner->recordScalar(name, profiling_data.counters[c]);
+    }
+#endif
+}
@@ -0,0 +1,90 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#ifndef __SRAWN_PROFILING_H_
+#define __SRAWN_PROFILING_H_
+
+#include <omnetpp.h>
+#include <stdint.h>
+#include <chrono>
+
+using namespace omnetpp;
+
+/*
+ * Hot-path instrumentation: number of events and CPU time of each handler, plus some model counters.
+ * The data are thread-local and they are reported as scalars by the chosen one at finish().
+ * Build with PROFILING=0 ( make PROFILING=0 ) to compile all of it away.
+ */
+
+// Instrumented handlers.
+
+enum ProfiledHandler {
+    PROFILE_TX_BEEP = 0,        //  Transmitter::handleBeepMessage
+    PROFILE_TX_CD,              //  Transmitter::handleCDMessage
+    PROFILE_TX_CLEAR,           //  Transmitter::handleClearMessage
+    PROFILE_TX_PACKET,          //  Transmitter::handlePacketMessage
+    PROFILE_GENERATOR,          //  Generator::handleMessage
+    PROFILE_RECEIVER,           //  Receiver::handleMessage, ReceiverSink::handleMessage
+    PROFILED_HANDLER_NUMBER
+};
+
+// Model counters.
+
+enum ProfiledCounter {
+    PROFILE_BERNOULLI_DRAWS = 0,
+    PROFILE_COLLISIONS,
+    PROFILE_BACKOFF_SLOTS,
+    PROFILED_COUNTER_NUMBER
+};
+
+struct ProfilingData {
+    uint64_t events[PROFILED_HANDLER_NUMBER];
+    uint64_t nanoseconds[PROFILED_HANDLER_NUMBER];
+    uint64_t counters[PROFILED_COUNTER_NUMBER];
+};
+
+extern thread_local ProfilingData profiling_data;
+
+/**
+ * It accumulates the time spent from its construction to its destruction into a handler.
+ */
+class ProfileScope
+{
+private:
+    int handler;
+    std::chrono::steady_clock::time_point start;
+
+public:
+    ProfileScope(int handler) : handler(handler), start(std::chrono::steady_clock::now()) {}
+
+    ~ProfileScope() {
+        profiling_data.events[handler]++;
+        profiling_data.nanoseconds[handler] += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count();
+    }
+};
+
+void resetProfiling();
+void recordProfilingScalars(cComponent *owner);
+
+#ifdef SRAWN_PROFILING
+#define PROFILE_HANDLER(handler)        ProfileScope profile_scope(handler)
+#define PROFILE_COUNT(counter, n)       (profiling_data.counters[counter] += (n))
+#else
+#define PROFILE_HANDLER(handler)
+#define PROFILE_COUNT(counter, n)
+#endif
+
+#endif
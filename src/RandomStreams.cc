@@ -0,0 +1,213 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#include "RandomStreams.h"
+
+#include <stdlib.h>
+#include <math.h>
+
+std::set<RandomStreams*> RandomStreams::instances;
+
+/**
+ * Mersenne Twister seeded with a 64-bit key through init_by_array: the 32-bit seed of
+ * cMersenneTwister::initialize() could not tell apart every seed-set, index and purpose.
+ */
+class KeyedMersenneTwister : public cMersenneTwister
+{
+public:
+    void seed(uint64_t key) {
+        MTRand::uint32 words[2] = { (MTRand::uint32) (key & 0xffffffff), (MTRand::uint32) (key >> 32) };
+        rand.seed(words, 2);
+        numDrawn = 0;
+    }
+};
+
+RandomStreams::RandomStreams() {
+
+    owner = 0;
+    index = 0;
+    purposes = 0;
+    dedicated = false;
+    antithetic = false;
+    fast = false;
+    threshold_prob = -1;
+    threshold = 0;
+
+    for (int k = 0; k < STREAM_PURPOSE_NUMBER; k++) {
+        streams[k] = 0;
+        fast_streams[k] = 0;
+    }
+}
+
+RandomStreams::~RandomStreams() {
+
+    release();
+}
+
+void RandomStreams::initialize(cComponent *owner, int index, cModule *cluster, int purposes) {
+
+    release();
+
+    std::string backend = cluster->par("rng_backend").stdstringValue();
+    if (backend != "omnetpp" && backend != "xoshiro")
+        throw cRuntimeError("Unknown rng_backend \"%s\": it must be \"omnetpp\" or \"xoshiro\"", backend.c_str());
+
+    this->owner = owner;
+    this->index = index;
+    this->purposes = purposes;
+    this->antithetic = cluster->par("antithetic_variates").boolValue();
+    this->fast = (backend == "xoshiro");
+    this->dedicated = cluster->par("dedicated_rng_streams").boolValue() || fast;
+    threshold_prob = -1;
+
+    if (!dedicated) {
+
+        // Shared mode: every purpose uses the default RNG of the module.
+        for (int k = 0; k < STREAM_PURPOSE_NUMBER; k++)
+            streams[k] = owner->getRNG(0);
+
+        return;
+    }
+
+    // Dedicated streams ( the xoshiro ones always are ): one generator for each purpose of the module.
+    for (int k = 0; k < STREAM_PURPOSE_NUMBER; k++) {
+        if (!(purposes & (1 << k)))
+            continue;
+        if (fast)
+            fast_streams[k] = new Xoshiro256();
+        else
+            streams[k] = new KeyedMersenneTwister();
+    }
+
+    reseed(currentSeedSet());
+    instances.insert(this);
+}
+
+/**
+ * The identifier of a stream depends only on the module index and on the purpose: with the seed-set
+ * it makes a 64-bit key, so no two seed-sets, indexes or purposes share a stream.
+ */
+void RandomStreams::reseed(int seed_set) {
+
+    if (!dedicated)
+        return;
+
+    for (int k = 0; k < STREAM_PURPOSE_NUMBER; k++) {
+
+        int stream_id = index * STREAM_PURPOSE_NUMBER + k;
+
+        if (fast_streams[k])
+            fast_streams[k]->seed(seed_set, stream_id, antithetic);
+        else if (streams[k])
+            static_cast<KeyedMersenneTwister*>(streams[k])->seed(streamSeed(seed_set, stream_id));
+    }
+}
+
+void RandomStreams::reseedAll(int seed_set) {
+
+    for (std::set<RandomStreams*>::iterator it = instances.begin(); it != instances.end(); ++it)
+        (*it)->reseed(seed_set);
+}
+
+int RandomStreams::currentSeedSet() {
+
+    return atoi(getEnvir()->getConfigEx()->getVariable("seedset"));
+}
+
+void RandomStreams::release() {
+
+    if (dedicated) {
+
+        instances.erase(this);
+        for (int k = 0; k < STREAM_PURPOSE_NUMBER; k++) {
+            delete streams[k];
+            delete fast_streams[k];
+        }
+    }
+
+    for (int k = 0; k < STREAM_PURPOSE_NUMBER; k++) {
+        streams[k] = 0;
+        fast_streams[k] = 0;
+    }
+
+    dedicated = false;
+    fast = false;
+}
+
+/* DRAWS */
+
+/**
+ * Without antithetic variates the OMNeT++ distributions are used as they are,
+ * so the shared mode reproduces exactly the original draws.
+ */
+double RandomStreams::uniform(int purpose, double a, double b) {
+
+    // The xoshiro streams apply the antithetic complement themselves.
+    if (fast)
+        return a + (b - a) * fast_streams[purpose]->doubleRand();
+
+    if (!antithetic)
+        return omnetpp::uniform(streams[purpose], a, b);
+
+    // 1-U with U in (0,1): the result stays in [a,b).
+    return a + (b - a) * (1 - streams[purpose]->doubleRandNonz());
+}
+
+double RandomStreams::exponential(int purpose, double mean) {
+
+    // U in [0,1): 1-U is never 0.
+    if (fast)
+        return -mean * log(1 - fast_streams[purpose]->doubleRand());
+
+    if (!antithetic)
+        return omnetpp::exponential(streams[purpose], mean);
+
+    // 1-U in place of U: log(1-(1-U)) = log(U), with U in (0,1).
+    return -mean * log(streams[purpose]->doubleRandNonz());
+}
+
+/**
+ * The xoshiro backend compares an integer draw with the threshold p * 2^64,
+ * computed once for each value of p.
+ */
+bool RandomStreams::bernoulli(int purpose, double p) {
+
+    if (fast) {
+
+        if (p != threshold_prob) {
+            threshold_prob = p;
+            threshold = (p >= 1) ? ~(uint64_t) 0 : (p <= 0) ? 0 : (uint64_t) (p * 18446744073709551616.0);
+        }
+
+        return fast_streams[purpose]->next64() < threshold || p >= 1;
+    }
+
+    if (!antithetic)
+        return omnetpp::bernoulli(streams[purpose], p) == 1;
+
+    return (1 - streams[purpose]->doubleRand()) < p;
+}
+
+/**
+ * The xoshiro backend draws an integer in [0, 2^exponent - 1) and shifts it by one:
+ * no pow() and no floating point.
+ */
+int RandomStreams::backoff(int purpose, int exponent) {
+
+    if (fast && exponent < 32)
+        return 1 + fast_streams[purpose]->intRand(((uint32_t) 1 << exponent) - 1);
+
+    return (int) uniform(purpose, 1, pow(2, exponent));
+}
@@ -0,0 +1,97 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#ifndef __SRAWN_RANDOMSTREAMS_H_
+#define __SRAWN_RANDOMSTREAMS_H_
+
+#include <omnetpp.h>
+#include <set>
+#include "Xoshiro.h"
+
+using namespace omnetpp;
+
+// Purpose of each random stream.
+
+enum RandomStreamPurpose {
+    ARRIVAL_STREAM = 0,     //  Generator: interarrival-times
+    CHANNEL_STREAM,         //  Transmitter: channel extraction
+    BERNOULLI_STREAM,       //  Transmitter: bernoullian test
+    BACKOFF_STREAM,         //  Transmitter: backoff slots
+    MEAN_FIELD_STREAM,      //  Transmitter ( chosen one ): transmissions of the background population
+    STREAM_PURPOSE_NUMBER
+};
+
+// Purposes owned by each kind of module: only their dedicated streams are allocated.
+
+#define GENERATOR_STREAMS ((1 << ARRIVAL_STREAM))
+#define TRANSMITTER_STREAMS ((1 << CHANNEL_STREAM) | (1 << BERNOULLI_STREAM) | (1 << BACKOFF_STREAM))
+
+/**
+ * Random number streams of a Transmitter or a Generator.
+ *
+ * - shared mode: all the draws come from the default RNG of the module, as in the original model.
+ * - dedicated mode: each module index and each purpose owns its stream, seeded by a 64-bit hash
+ *   of the seed-set, the index and the purpose, so the same transmitter sees the same numbers in
+ *   every configuration (common random numbers).
+ * - xoshiro backend: dedicated streams drawn from inline xoshiro256** generators, with
+ *   batched outputs, integer bernoullian test and power-of-two backoff; seeded by the seed-set.
+ * With antithetic variates every uniform number U is replaced by 1-U.
+ */
+class RandomStreams
+{
+private:
+    cComponent *owner;
+    int index;
+    int purposes;                 //  Bit mask of the purposes the module owns
+    bool dedicated;
+    bool antithetic;
+    bool fast;                    //  xoshiro backend
+    cRNG *streams[STREAM_PURPOSE_NUMBER];
+    Xoshiro256 *fast_streams[STREAM_PURPOSE_NUMBER];
+
+    // Integer threshold of the last bernoullian probability: P(X < threshold) = p.
+    double threshold_prob;
+    uint64_t threshold;
+
+    // Every dedicated stream in the process: a forked replica has to reseed them.
+    static std::set<RandomStreams*> instances;
+
+public:
+    RandomStreams();
+    ~RandomStreams();
+
+    // Mode and backend come from the parameters of the cluster: dedicated_rng_streams,
+    // antithetic_variates and rng_backend. "purposes" is the bit mask of the streams the module draws from.
+    void initialize(cComponent *owner, int index, cModule *cluster, int purposes);
+    void reseed(int seed_set);
+
+    static void reseedAll(int seed_set);
+    static int currentSeedSet();
+
+    double uniform(int purpose, double a, double b);
+    double exponential(int purpose, double mean);
+    bool bernoulli(int purpose, double p);
+    // Uniform integer in [1, 2^exponent - 1], as (int) uniform(1, 2^exponent).
+    int backoff(int purpose, int exponent);
+
+    // A draw whose value is not needed: a shared RNG still advances, so that the sequence seen by
+    // the other purposes does not change; a dedicated stream serves only this purpose and is left alone.
+    void skipDraw(int purpose) { if (!dedicated) streams[purpose]->doubleRand(); }
+
+protected:
+    void release();
+};
+
+#endif
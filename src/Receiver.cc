@@ -7,25 +7,52 @@ void Receiver::initialize()
 {
     // Register at omnet++ the signal.
     delay_time_signal = registerSignal("delay_time");
+
+    cModule* transmitter_cluster = getSimulation()->getModuleByPath("SRAWN.transmitter_cluster");
+    slot_time_domain = transmitter_cluster->par("slot_time_domain").boolValue();
+    slot_time = transmitter_cluster->par("slot_time").doubleValue();
+
+    importance_receiver = ((int) transmitter_cluster->par("importance_tagged") == getIndex());
+    if (importance_receiver)
+        importance_estimator.configure(transmitter_cluster->par("importance_delay_thresholds").stringValue(),
+                transmitter_cluster->par("importance_collision_thresholds").stringValue());
 }
 
 void Receiver::handleMessage(cMessage *msg)
 {
 
+    PROFILE_HANDLER(PROFILE_RECEIVER);
+
     // Calculate the delay-time of the received packet.
     Packet* p = check_and_cast<Packet*>(msg);
-    simtime_t packet_delay = (simtime_t)(p->getTransmission_time() - p->getGeneration_time());
+    simtime_t packet_delay;
+    if (slot_time_domain)
+        packet_delay = ((p->getTransmission_slot() - p->getGeneration_slot()) - p->getGeneration_offset()) * slot_time;
+    else
+        packet_delay = (simtime_t)(p->getTransmission_time() - p->getGeneration_time());
 
     // Emit the delay-time of the received packet.
     emit( delay_time_signal, packet_delay );
 
+    // Feed the delay percentiles of the live metrics.
+    LiveMetrics::packetDelivered(SIMTIME_DBL(packet_delay));
+
+    if (simTime() > getSimulation()->getWarmupPeriod())
+        RunSummary::collectDelay(SIMTIME_DBL(packet_delay));
 
-    // Get measurement unit of the slot time.
-    const char* measurement_unit = getSimulation()->getModuleByPath("SRAWN.transmitter_cluster")->par("slot_time").getUnit();
+    if (importance_receiver && p->getImportance_probe() && simTime() > getSimulation()->getWarmupPeriod())
+        importance_estimator.collect(SIMTIME_DBL(packet_delay), p->getCollision_number(), p->getLikelihood_ratio());
 
     // Print statistics informations for debugging.
-    //EV<<"GEN: "<<p->getGeneration_time()<<measurement_unit<<" TRANS: "<<p->getTransmission_time()<<measurement_unit<<" DELAY: "<<packet_delay<<measurement_unit<<endl;
+    //EV<<"GEN: "<<p->getGeneration_time()<<" TRANS: "<<p->getTransmission_time()<<" DELAY: "<<packet_delay<<endl;
 
     //Deleting of the received message
     delete p;
+    memoryReleased(MEMORY_PENDING_PACKETS, sizeof(Packet));
+}
+
+void Receiver::finish()
+{
+    if (importance_receiver)
+        importance_estimator.record(this);
 }
@@ -18,6 +18,11 @@
 
 #include <omnetpp.h>
 #include "Packet_m.h"
+#include "LiveMetrics.h"
+#include "Profiling.h"
+#include "RunSummary.h"
+#include "ImportanceSampling.h"
+#include "MemoryAccounting.h"
 using namespace omnetpp;
 
 /**
@@ -29,9 +34,18 @@ private:
     // Signal: it registers the delay-time of each received channel.
     simsignal_t delay_time_signal;
 
+    // Slot-time domain: the delay is computed in slots and converted once with slot_time.
+    bool slot_time_domain;
+    double slot_time;
+
+    // Importance sampling: the receiver of the tagged transmitter weights its probe packets.
+    bool importance_receiver;
+    ImportanceEstimator importance_estimator;
+
   protected:
     virtual void initialize();
     virtual void handleMessage(cMessage *msg);
+    virtual void finish();
 };
 
 #endif
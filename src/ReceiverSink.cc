@@ -0,0 +1,113 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#include "ReceiverSink.h"
+#include "LiveMetrics.h"
+#include "Profiling.h"
+#include "RunSummary.h"
+
+Define_Module(ReceiverSink);
+
+void ReceiverSink::initialize()
+{
+    delay_time_signal = registerSignal("delay_time");
+
+    receiver_size = (int) par("receiver_size");
+    channel_size = (int) par("channel_size");
+    per_receiver_statistics = par("per_receiver_statistics").boolValue();
+
+    // The gates of a vector have consecutive identifiers.
+    gate_base_id = gateBaseId("channel_array");
+
+    cModule* transmitter_cluster = getSimulation()->getModuleByPath("SRAWN.transmitter_cluster");
+    slot_time_domain = transmitter_cluster->par("slot_time_domain").boolValue();
+    slot_time = transmitter_cluster->par("slot_time").doubleValue();
+
+    if (per_receiver_statistics) {
+        received_packets.assign(receiver_size, 0);
+        delay_sum.assign(receiver_size, 0);
+        delay_max.assign(receiver_size, 0);
+    }
+
+    importance_receiver = (int) transmitter_cluster->par("importance_tagged");
+    if (importance_receiver >= 0)
+        importance_estimator.configure(transmitter_cluster->par("importance_delay_thresholds").stringValue(),
+                transmitter_cluster->par("importance_collision_thresholds").stringValue());
+}
+
+void ReceiverSink::handleMessage(cMessage *msg)
+{
+    PROFILE_HANDLER(PROFILE_RECEIVER);
+
+    // Calculate the delay-time of the received packet, as a Receiver does.
+    Packet* p = check_and_cast<Packet*>(msg);
+    simtime_t packet_delay;
+    if (slot_time_domain)
+        packet_delay = ((p->getTransmission_slot() - p->getGeneration_slot()) - p->getGeneration_offset()) * slot_time;
+    else
+        packet_delay = (simtime_t)(p->getTransmission_time() - p->getGeneration_time());
+
+    emit(delay_time_signal, packet_delay);
+
+    LiveMetrics::packetDelivered(SIMTIME_DBL(packet_delay));
+
+    // The adaptive warm-up can move the warm-up period: it is read at every packet.
+    if (simTime() > getSimulation()->getWarmupPeriod()) {
+
+        double delay = SIMTIME_DBL(packet_delay);
+        int receiver = (msg->getArrivalGateId() - gate_base_id) / channel_size;
+
+        RunSummary::collectDelay(delay);
+
+        if (per_receiver_statistics) {
+            received_packets[receiver]++;
+            delay_sum[receiver] += delay;
+            if (delay > delay_max[receiver])
+                delay_max[receiver] = delay;
+        }
+
+        if (receiver == importance_receiver && p->getImportance_probe())
+            importance_estimator.collect(delay, p->getCollision_number(), p->getLikelihood_ratio());
+    }
+
+    delete p;
+    memoryReleased(MEMORY_PENDING_PACKETS, sizeof(Packet));
+}
+
+void ReceiverSink::finish()
+{
+    if (per_receiver_statistics) {
+
+        long total_packets = 0;
+        char name[64];
+
+        for (int i = 0; i < receiver_size; i++) {
+
+            sprintf(name, "received_packets:rx%d", i);
+            recordScalar(name, received_packets[i]);
+            sprintf(name, "delay_mean:rx%d", i);
+            recordScalar(name, received_packets[i] > 0 ? delay_sum[i] / received_packets[i] : 0);
+            sprintf(name, "delay_max:rx%d", i);
+            recordScalar(name, delay_max[i]);
+
+            total_packets += received_packets[i];
+        }
+
+        recordScalar("received_packets", total_packets);
+    }
+
+    if (importance_receiver >= 0)
+        importance_estimator.record(this);
+}
@@ -0,0 +1,62 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#ifndef __SRAWN_RECEIVERSINK_H_
+#define __SRAWN_RECEIVERSINK_H_
+
+#include <omnetpp.h>
+#include <vector>
+
+#include "Packet_m.h"
+#include "ImportanceSampling.h"
+#include "MemoryAccounting.h"
+
+using namespace omnetpp;
+
+/**
+ * Compact sink of the receiver cluster ( compact_sink = true ): a single module in place of the
+ * receiver_size Receivers. The receiver of a packet is the index of its arrival gate divided by
+ * channel_size; its counters and delay accumulators are kept in flat arrays.
+ */
+class ReceiverSink : public cSimpleModule
+{
+private:
+    simsignal_t delay_time_signal;
+
+    int receiver_size;
+    int channel_size;
+    int gate_base_id;
+
+    // Configuration of the transmitter cluster, read once.
+    bool slot_time_domain;
+    double slot_time;
+    bool per_receiver_statistics;
+
+    // Packets received by each receiver after the warm-up period, with the sum and the maximum of their delays.
+    std::vector<long> received_packets;
+    std::vector<double> delay_sum;
+    std::vector<double> delay_max;
+
+    // Importance sampling: index of the receiver of the tagged transmitter ( -1: off ).
+    int importance_receiver;
+    ImportanceEstimator importance_estimator;
+
+protected:
+    virtual void initialize();
+    virtual void handleMessage(cMessage *msg);
+    virtual void finish();
+};
+
+#endif
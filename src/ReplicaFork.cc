@@ -0,0 +1,185 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#include "ReplicaFork.h"
+#include "RandomStreams.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+ReplicaFork::ReplicaFork() {
+
+    replica_index = -1;
+}
+
+ReplicaFork::~ReplicaFork() {
+
+    for (size_t i = 0; i < pipes.size(); i++)
+        if (pipes[i] >= 0)
+            close(pipes[i]);
+}
+
+/**
+ * It forks the process: the parent keeps the index 0, each child gets its own index
+ * and a new seed-set, so that all the replicas share the same warm state but continue independently.
+ */
+int ReplicaFork::forkReplicas(int replicas) {
+
+    if (getEnvir()->isGUI())
+        throw cRuntimeError("Fork-from-warm-state replications are only supported by Cmdenv");
+
+    // Flush the output before forking, otherwise the children would print it again.
+    fflush(stdout);
+    fflush(stderr);
+
+    replica_index = 0;
+
+    for (int r = 1; r < replicas; r++) {
+
+        int fd[2];
+        if (pipe(fd) != 0)
+            throw cRuntimeError("Cannot create the pipe for replica %d", r);
+
+        pid_t pid = fork();
+
+        if (pid < 0)
+            throw cRuntimeError("Cannot fork replica %d", r);
+
+        if (pid == 0) {
+
+            // Child: it keeps only the write end of its own pipe.
+            close(fd[0]);
+            for (size_t i = 0; i < pipes.size(); i++)
+                close(pipes[i]);
+            pipes.clear();
+            children.clear();
+            pipes.push_back(fd[1]);
+
+            replica_index = r;
+            detachInheritedFiles(fd[1]);
+            reseed(r);
+
+            return replica_index;
+        }
+
+        // Parent: it keeps the read end.
+        close(fd[1]);
+        pipes.push_back(fd[0]);
+        children.push_back(pid);
+    }
+
+    return replica_index;
+}
+
+void ReplicaFork::reseed(int replica) {
+
+    cConfigurationEx *cfg = getEnvir()->getConfigEx();
+    int seed_set = RandomStreams::currentSeedSet() + replica * FORK_SEED_SET_STRIDE;
+    int rng_number = getEnvir()->getNumRNGs();
+
+    for (int k = 0; k < rng_number; k++)
+        getEnvir()->getRNG(k)->initialize(seed_set, k, rng_number, 0, 1, cfg);
+
+    // The dedicated streams of the transmitters and of the generators too.
+    RandomStreams::reseedAll(seed_set);
+
+    EV << "REPLICA " << replica << " RESEEDED WITH SEED-SET " << seed_set << endl;
+}
+
+/**
+ * Child side: every descriptor inherited from the parent, except the standard streams and the pipe
+ * "keep", is pointed to /dev/null. The result managers of the child keep writing ( the buffered lines
+ * of the parent too ), but nothing reaches the parent's files, whatever vector-recording says.
+ */
+void ReplicaFork::detachInheritedFiles(int keep) {
+
+    std::vector<int> inherited;
+
+    DIR *fds = opendir("/proc/self/fd");
+    if (!fds)
+        throw cRuntimeError("Cannot list the files of replica %d", replica_index);
+
+    struct dirent *entry;
+    while ((entry = readdir(fds)) != 0) {
+        int fd = atoi(entry->d_name);
+        if (fd > 2 && fd != keep && fd != dirfd(fds))
+            inherited.push_back(fd);
+    }
+
+    closedir(fds);
+
+    int null_fd = open("/dev/null", O_WRONLY);
+    if (null_fd < 0)
+        throw cRuntimeError("Cannot open /dev/null in a replica");
+
+    for (size_t i = 0; i < inherited.size(); i++)
+        if (inherited[i] != null_fd)
+            dup2(null_fd, inherited[i]);
+
+    close(null_fd);
+}
+
+void ReplicaFork::publishAndExit(const std::vector<double>& results) {
+
+    int count = results.size();
+
+    if (write(pipes[0], &count, sizeof(count)) == sizeof(count) && count > 0)
+        if (write(pipes[0], &results[0], count * sizeof(double)) < 0)
+            perror("ReplicaFork");
+
+    close(pipes[0]);
+    fflush(stdout);
+
+    // Skip every destructor and atexit handler: nothing of the child is left to flush.
+    _exit(0);
+}
+
+std::vector< std::vector<double> > ReplicaFork::collect() {
+
+    std::vector< std::vector<double> > results(pipes.size());
+
+    for (size_t i = 0; i < pipes.size(); i++) {
+
+        int count = 0;
+
+        if (read(pipes[i], &count, sizeof(count)) == sizeof(count) && count > 0) {
+
+            results[i].resize(count);
+            char *buffer = (char*) &results[i][0];
+            size_t left = count * sizeof(double);
+
+            while (left > 0) {
+                ssize_t n = read(pipes[i], buffer, left);
+                if (n <= 0)
+                    break;
+                buffer += n;
+                left -= n;
+            }
+
+            if (left > 0)
+                results[i].clear();
+        }
+
+        close(pipes[i]);
+        pipes[i] = -1;
+
+        waitpid(children[i], 0, 0);
+    }
+
+    return results;
+}
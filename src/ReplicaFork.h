@@ -0,0 +1,69 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#ifndef __SRAWN_REPLICAFORK_H_
+#define __SRAWN_REPLICAFORK_H_
+
+#include <omnetpp.h>
+#include <vector>
+#include <sys/types.h>
+
+using namespace omnetpp;
+
+// Distance between the seed-sets of two forked replicas: it keeps the children
+// streams far from the seed-sets used by the ordinary "repeat" runs.
+
+#define FORK_SEED_SET_STRIDE 1000003
+
+/**
+ * Fork-from-warm-state replications.
+ *
+ * The warm-up period is simulated once; then the process forks (copy-on-write)
+ * into "replicas - 1" children. Every child reseeds the RNGs and continues
+ * independently; at the end it sends its results back to the parent through
+ * a pipe and exits. In the children the files inherited from the parent
+ * ( .vec, .sca, traces ) point to /dev/null: nothing they record reaches them.
+ * Replica 0 is the parent process itself.
+ */
+class ReplicaFork
+{
+private:
+    int replica_index;                  //  0 for the parent, 1..replicas-1 for the children
+    std::vector<int> pipes;             //  Parent: read end of the pipe of each child. Child: only its write end.
+    std::vector<pid_t> children;        //  Parent: pid of each child
+
+public:
+    ReplicaFork();
+    ~ReplicaFork();
+
+    // It forks the process into "replicas" replicas and returns the index of the calling one.
+    int forkReplicas(int replicas);
+
+    bool isForked() const { return replica_index != -1; }
+    bool isChild() const { return replica_index > 0; }
+    int getReplicaIndex() const { return replica_index; }
+
+    // Child side: send the results to the parent and terminate the process.
+    void publishAndExit(const std::vector<double>& results);
+
+    // Parent side: wait for every child and collect its results.
+    std::vector< std::vector<double> > collect();
+
+protected:
+    void reseed(int replica);
+    void detachInheritedFiles(int keep);
+};
+
+#endif
@@ -0,0 +1,54 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#include "RunSummary.h"
+
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+double RunSummary::queue_length_sum = 0;
+uint64_t RunSummary::queue_length_samples = 0;
+double RunSummary::delay_sum = 0;
+uint64_t RunSummary::delivered_packets = 0;
+
+void RunSummary::reset() {
+
+    queue_length_sum = 0;
+    queue_length_samples = 0;
+    delay_sum = 0;
+    delivered_packets = 0;
+}
+
+bool RunSummary::append(const char *file, const RunSummaryPoint& point, double throughput) {
+
+    char row[512];
+
+    int length = snprintf(row, sizeof(row), "%d,%d,%g,%g,%d,%.9g,%.9g,%.9g,%llu\n",
+            point.transmitter_size, point.channel_size, point.exponential_send_mean_time,
+            point.bernoullian_prob, point.repetition, throughput,
+            (queue_length_samples > 0) ? queue_length_sum / queue_length_samples : 0.0,
+            (delivered_packets > 0) ? delay_sum / delivered_packets : 0.0,
+            (unsigned long long) delivered_packets);
+
+    int fd = open(file, O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (fd < 0)
+        return false;
+
+    bool written = (write(fd, row, length) == length);
+    close(fd);
+
+    return written;
+}
@@ -0,0 +1,59 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#ifndef __SRAWN_RUNSUMMARY_H_
+#define __SRAWN_RUNSUMMARY_H_
+
+#include <stdint.h>
+
+/*
+ * Summary of one run, gathered after the warm-up period: it is appended as one CSV row
+ * to the sweep summary file, shared by all the runs of a parameter sweep.
+ *
+ * Columns: transmitter_size, channel_size, exponential_send_mean_time, bernoullian_prob, repetition,
+ *          throughput, mean_queue_length, mean_delay, delivered_packets.
+ */
+
+#define RUN_SUMMARY_HEADER "transmitter_size,channel_size,exponential_send_mean_time,bernoullian_prob,repetition,throughput,mean_queue_length,mean_delay,delivered_packets\n"
+
+struct RunSummaryPoint {
+    int transmitter_size;
+    int channel_size;
+    double exponential_send_mean_time;
+    double bernoullian_prob;
+    int repetition;
+};
+
+class RunSummary
+{
+public:
+    // Accumulators fed by the Transmitters (queue length per slot) and by the Receivers (delay).
+    static double queue_length_sum;
+    static uint64_t queue_length_samples;
+    static double delay_sum;
+    static uint64_t delivered_packets;
+
+    static void reset();
+
+    static void collectQueueLength(int length) { queue_length_sum += length; queue_length_samples++; }
+    static void collectDelay(double delay) { delay_sum += delay; delivered_packets++; }
+    // Slots skipped by the fast-forward: their queue length is 0.
+    static void collectIdleSlots(int slots) { queue_length_samples += slots; }
+
+    // It appends the row of this run with a single write(), so that concurrent runs do not mix their rows.
+    static bool append(const char *file, const RunSummaryPoint& point, double throughput);
+};
+
+#endif
@@ -14,26 +14,52 @@
 // 
 
 #include "Transmitter.h"
+#include "Generator.h"
+#include "Medium.h"
+
+#include <limits.h>
+#include <algorithm>
 
 Define_Module(Transmitter);
 
 Transmitter::Transmitter() {
 
     // Initialize internal variables
-    id = id_number++;
+    id = 0;
     slot_counter = 0;
     slot_to_wait = 0;
 
     clear_packet_variables();
 
-    // Initialize the queue
-    char queue_name[10] = "/0";
-    sprintf(queue_name, "queue_%d", id);
-    queue.setName(queue_name);
+    cluster = 0;
+    channels = 0;
+    channel_successful_slot_counter_array = 0;
+    background_attempts = 0;
+    population = 0;
+    mean_field_alpha = 0;
+    message_medium = false;
+    medium_transmissions = 0;
+    importance_tagged = false;
+    importance_prob = -1;
+    importance_tilt = 1;
 
     // Initialize statistic's support variables
     sent_packets = 0;
 
+    fork_replicas = 1;
+    warmed_up = false;
+    warm_slot_counter = 0;
+    live_metrics_period = 0;
+    channel_table = 0;
+    adaptive_warmup = false;
+    adaptive_warmup_window = 0;
+    adaptive_warmup_tolerance = 0;
+    window_queued_packets = 0;
+    window_slots = 0;
+    previous_window_mean = -1;
+    memory_accounting_enabled = false;
+    memory_sample_period = 0;
+
 }
 
 Transmitter::~Transmitter() {
@@ -46,58 +72,206 @@ void Transmitter::initialize() {
     slotBeep = new cMessage("slot beep");
     collisionDetectionBeep = new cMessage("cd beep");
     clearBeep = new cMessage("clear beep");
+    for (int i = 0; i < 3; i++)
+        memoryAllocated(MEMORY_CONTROL_MESSAGES, sizeof(cMessage));
+
+    // The identifier is the index in the cluster: it starts from 0 in every network.
+    id = getIndex();
+
+    // Initialize the queue
+    char queue_name[32];
+    sprintf(queue_name, "queue_%d", id);
+    queue.setName(queue_name);
 
     // Initialized internal variables [ depending from parameters ].
     local_channel_size = (int) par("channel_size");
     transmitter_size = (int) getParentModule()->par("transmitter_size");
-    int total_channel_size = local_channel_size * transmitter_size;
 
-    if (channels == 0) {
-        channels = new int[total_channel_size];
-        for (int i = 0; i < total_channel_size; i++)
-            channels[i] = 0;
-    }
+    // Shared variables: the cluster has already allocated them.
+    cluster = check_and_cast<TransmitterCluster*>(getParentModule());
+    channels = cluster->channels;
+
+    // Channel selection weights: the transmitter's own, otherwise the ones of the cluster.
+    const char* channel_weights = par("channel_weights").stringValue();
+    if (strlen(channel_weights) == 0)
+        channel_weights = getParentModule()->par("channel_weights").stringValue();
+
+    channel_table = 0;
+
+    if (strlen(channel_weights) > 0) {
+
+        std::vector<double> weights = cStringTokenizer(channel_weights).asDoubleVector();
+        double weight_sum = 0;
 
-    if (channel_successful_slot_counter_array == 0) {
-        channel_successful_slot_counter_array = new int[local_channel_size];
-        for (int i = 0; i < local_channel_size; ++i)
-            channel_successful_slot_counter_array[i] = 0;
+        if ((int) weights.size() != local_channel_size)
+            throw cRuntimeError("channel_weights has %d values for %d channels", (int) weights.size(), local_channel_size);
+
+        for (size_t j = 0; j < weights.size(); j++) {
+            if (weights[j] < 0)
+                throw cRuntimeError("channel_weights cannot be negative");
+            weight_sum += weights[j];
+        }
+
+        if (weight_sum <= 0)
+            throw cRuntimeError("channel_weights must have a positive sum");
+
+        channel_table = cluster->channelTable(weights);
     }
+    channel_successful_slot_counter_array = cluster->channel_successful_slot_counter_array;
+
+    // Mean-field mode: the population is larger than the simulated transmitters.
+    background_attempts = cluster->background_attempts;
+    population = (cluster->population > 0) ? cluster->population : transmitter_size;
+    mean_field_alpha = 1.0 / (int) getParentModule()->par("mean_field_window");
 
     // Initialize bernoullian probability.
     //bernoullian_prob = 0.3678;    1/e : for C = 1
-    if (local_channel_size > transmitter_size)
+    // A negative parameter means "automatic": C/N, at most 1 ( N is the whole population ).
+    if (par("bernoullian_prob").doubleValue() >= 0)
+        bernoullian_prob = par("bernoullian_prob").doubleValue();
+    else if (local_channel_size > population)
         bernoullian_prob = 1;    //C>T
     else
-        bernoullian_prob = local_channel_size / (double) transmitter_size;
+        bernoullian_prob = local_channel_size / (double) population;
     //EV << "Bernoullian Prob:\t" << bernoullian_prob << endl;
 
-    // The transmitter starts to work by sending it self a synchronization message
-    sendSlotBeep();
+    slot_time_domain = getParentModule()->par("slot_time_domain").boolValue();
+
+    // Message-based medium: the channel state lives in the Medium module, possibly in another partition,
+    // so the features of the chosen one that read the shared matrix are not available.
+    message_medium = getParentModule()->par("message_medium").boolValue();
+
+    if (message_medium && ((int) getParentModule()->par("fork_replicas") > 1
+            || strlen(getParentModule()->par("channel_trace_file").stringValue()) > 0
+            || (int) getParentModule()->par("live_metrics_period") > 0
+            || strlen(getParentModule()->par("sweep_summary_file").stringValue()) > 0
+            || getParentModule()->par("fast_forward").boolValue()
+            || (int) getParentModule()->par("mean_field_population") > 0
+            || getParentModule()->par("adaptive_warmup").boolValue()
+            || (getParentModule()->par("memory_accounting").boolValue() && (int) getParentModule()->par("memory_sample_period") > 0)))
+        throw cRuntimeError("message_medium cannot be used with fork_replicas, channel_trace_file, live_metrics_period, "
+                "sweep_summary_file, fast_forward, mean_field_population, adaptive_warmup or memory_sample_period");
+
+    // Importance sampling: only the tagged transmitter biases its draws.
+    int importance_index = (int) getParentModule()->par("importance_tagged");
+    if (importance_index < -1 || importance_index >= transmitter_size)
+        throw cRuntimeError("importance_tagged must be -1 or the index of a transmitter, less than %d", transmitter_size);
+
+    importance_tagged = (importance_index == getIndex());
+    importance_prob = getParentModule()->par("importance_bernoullian_prob").doubleValue();
+    importance_tilt = getParentModule()->par("importance_backoff_tilt").doubleValue();
+
+    // A negative probability leaves the test unbiased; 0 would never let the probe through.
+    if (importance_tagged && (importance_prob == 0 || importance_prob >= 1 || importance_tilt <= 0))
+        throw cRuntimeError("importance_bernoullian_prob must be negative ( not biased ) or in (0,1), "
+                "and importance_backoff_tilt positive");
+
+    // With p = 1 ( e.g. C >= N ) the test always succeeds and is not drawn at all: there is nothing to bias.
+    if (importance_tagged && importance_prob >= 0 && bernoullian_prob >= 1)
+        throw cRuntimeError("importance_bernoullian_prob cannot be used when the bernoullian probability is 1: "
+                "leave it negative and bias only the backoff");
+
+    // Specialized slot logic for this regime.
+    selectSlotHandlers();
+
+    // Random streams: dedicated streams allow common random numbers across configurations.
+    // Only the chosen one draws the transmissions of the mean-field background.
+    int stream_purposes = TRANSMITTER_STREAMS;
+    if (par("choosen_one") && background_attempts)
+        stream_purposes |= (1 << MEAN_FIELD_STREAM);
+
+    random_streams.initialize(this, getIndex(), getParentModule(), stream_purposes);
+
+    // Instrumentation and run summary: the chosen one clears them at the beginning of each run.
+    if (par("choosen_one")) {
+        resetProfiling();
+        RunSummary::reset();
+    }
 
-    //REGISTERING SIGNALS
-    // - Throughput for each channel
+    // Per-slot channel activity trace: only the chosen one records it.
+    const char* channel_trace_file = getParentModule()->par("channel_trace_file").stringValue();
+
+    if (par("choosen_one") && strlen(channel_trace_file) > 0) {
+
+        if (!channel_trace.open(channel_trace_file, local_channel_size))
+            throw cRuntimeError("Cannot create the channel trace %s", channel_trace_file);
+
+        channel_attempts.assign(local_channel_size, 0);
+    }
+
+    // Live metrics: only the chosen one publishes them.
+    if (par("choosen_one"))
+        live_metrics_period = (int) getParentModule()->par("live_metrics_period");
+
+    if (live_metrics_period > 0) {
+
+        const char* live_metrics_name = getParentModule()->par("live_metrics_name").stringValue();
+        std::string segment;
 
-    if (channel_throughput_array == 0)
-        channel_throughput_array = new simsignal_t[local_channel_size];
+        if (!LiveMetrics::segmentName(live_metrics_name, segment))
+            throw cRuntimeError("live_metrics_name %s may hold one %%d and no other %%", live_metrics_name);
+
+        if (!live_metrics.open(live_metrics_name, transmitter_size, local_channel_size))
+            throw cRuntimeError("Cannot create the live metrics segment %s", live_metrics_name);
+    }
 
-    simsignal_t signal;    //temp signal
-    cProperty *statisticTemplate;
+    // Memory accounting: only the chosen one samples and records it.
+    if (par("choosen_one")) {
+        memory_accounting_enabled = getParentModule()->par("memory_accounting").boolValue();
+        memory_sample_period = memory_accounting_enabled ? (int) getParentModule()->par("memory_sample_period") : 0;
+    }
 
-    for (int i = 0; i < local_channel_size; ++i) {
+    if (memory_accounting_enabled && memory_sample_period > 0) {
 
-        char signalName[32];
+        char vector_name[64];
 
-        sprintf(signalName, "channel_throughput%d", i);
+        for (int c = 0; c < MEMORY_CATEGORY_NUMBER; c++) {
+            sprintf(vector_name, "memory_%s_bytes", memoryCategoryName(c));
+            memory_bytes_vectors[c].setName(vector_name);
+            memory_bytes_vectors[c].setUnit("B");
+        }
 
-        signal = registerSignal(signalName);
-        statisticTemplate = getProperties()->get("statisticTemplate",
-                "channel_throughput_signal");
-        getEnvir()->addResultRecorders(this, signal, signalName,
-                statisticTemplate);
-        channel_throughput_array[i] = registerSignal(signalName);
+        memory_total_vector.setName("memory_total_bytes");
+        memory_total_vector.setUnit("B");
     }
 
+    // Number of replicas forked from the warm state: only the chosen one does it.
+    fork_replicas = (int) getParentModule()->par("fork_replicas");
+
+    // Fast-forward over idle periods: the chosen one drives the slot clocks of every transmitter.
+    fast_forward = getParentModule()->par("fast_forward").boolValue();
+
+    // The background population is never idle.
+    if (fast_forward && background_attempts)
+        throw cRuntimeError("fast_forward cannot be used in the mean-field mode");
+
+    if (fast_forward && par("choosen_one")) {
+
+        for (int i = 0; i < transmitter_size; i++) {
+            transmitters.push_back(check_and_cast<Transmitter*>(getParentModule()->getSubmodule("tx_array", i)));
+            generators.push_back(check_and_cast<Generator*>(getParentModule()->getSubmodule("generator_array", i)));
+        }
+    }
+
+    // Adaptive warm-up: only the chosen one watches the queues.
+    if (par("choosen_one")) {
+        adaptive_warmup = getParentModule()->par("adaptive_warmup").boolValue();
+        adaptive_warmup_window = (int) getParentModule()->par("adaptive_warmup_window");
+        adaptive_warmup_tolerance = getParentModule()->par("adaptive_warmup_tolerance").doubleValue();
+    }
+
+    if (adaptive_warmup && adaptive_warmup_window <= 0)
+        throw cRuntimeError("adaptive_warmup_window must be positive");
+
+    // Warm-start continuation: the queue left by the previous run.
+    if (cluster->warm_started)
+        restoreWarmState();
+
+    // The transmitter starts to work by sending it self a synchronization message
+    sendSlotBeep();
+
+    //REGISTERING SIGNALS
+    // - Throughput for each channel: registered once by the cluster.
 
     // - queue dimension per slot time
 
@@ -116,45 +290,96 @@ void Transmitter::handleMessage(cMessage *msg) {
 
     if (msg == slotBeep) {
 
-        handleBeepMessage();
+        PROFILE_HANDLER(PROFILE_TX_BEEP);
+        (this->*beep_handler)();
     }
 
     else if (msg == collisionDetectionBeep) {
 
+        PROFILE_HANDLER(PROFILE_TX_CD);
         cancelEvent(msg);
-        handleCDMessage();
+        (this->*cd_handler)();
     }
 
     else if (msg == clearBeep) {
 
+        PROFILE_HANDLER(PROFILE_TX_CLEAR);
         cancelEvent(msg);
         handleClearMessage();
     }
 
     else if (strcmp(msg->getName(), packetName) == 0) {
 
+        PROFILE_HANDLER(PROFILE_TX_PACKET);
         handlePacketMessage(msg);
     }
+
+    else if (msg->arrivedOn("medium_in")) {
+
+        // Verdict of the medium: its kind is the number of transmissions on the channel.
+        medium_transmissions = msg->getKind();
+        delete msg;
+        memoryReleased(MEMORY_CONTROL_MESSAGES, sizeof(cMessage));
+    }
 }
 
 void Transmitter::finish() {
 
+    // A forked replica appends its own run summary, hands its results to the parent and leaves:
+    // the result files belong to the parent.
+    if (replica_fork.isChild()) {
+        appendRunSummary();
+        replica_fork.publishAndExit(replicaResults());
+    }
+
+    if (replica_fork.isForked())
+        mergeReplicaResults();
+
+    if (par("choosen_one"))
+        appendRunSummary();
+
+    if (par("choosen_one"))
+        recordProfilingScalars(this);
+
+    if (par("choosen_one") && background_attempts)
+        recordMeanFieldBound();
+
+    if (par("choosen_one")) {
+        recordScalar("warm_started", cluster->warm_started);
+        recordScalar("warmup_period", getSimulation()->getWarmupPeriod());
+    }
+
+    // The cluster saves the states of the transmitters for the next run.
+    storeWarmState();
+
+    // A probe still queued goes to the estimator of the receiver, which finishes after the transmitters.
+    if (importanceProbe() && ImportanceEstimator::tagged && simTime() > getSimulation()->getWarmupPeriod())
+        ImportanceEstimator::tagged->collectUndelivered(get_collision_number(),
+                check_and_cast<Packet*>(queue.front())->getLikelihood_ratio());
+
+    if (memory_accounting_enabled)
+        recordMemoryScalars(this);
+
     // Cancel and delete the messages and the related //EVents.
     cancelAndDelete(slotBeep);
     cancelAndDelete(collisionDetectionBeep);
     cancelAndDelete(clearBeep);
+    for (int i = 0; i < 3; i++)
+        memoryReleased(MEMORY_CONTROL_MESSAGES, sizeof(cMessage));
 
     // Clear the queue
-    while (!queue.isEmpty())
+    while (!queue.isEmpty()) {
         delete queue.pop();
-
-    // Delete global variables.
-    if (par("choosen_one")) {
-        delete[] channels;
-        delete[] channel_successful_slot_counter_array;
-        delete[] channel_throughput_array;
+        memoryReleased(MEMORY_QUEUED_PACKETS, sizeof(Packet) + MEMORY_QUEUE_NODE_BYTES);
     }
 
+    channel_trace.close();
+
+    live_metrics.markFinished();
+    if (live_metrics_period > 0 && !getParentModule()->par("live_metrics_keep").boolValue())
+        live_metrics.remove();
+    live_metrics.close();
+
 }
 
 // SELF-SENT MESSAGES
@@ -179,6 +404,31 @@ void Transmitter::sendClearBeep() {
 
 // ********** HANDLING FUNCTIONS **********
 
+/**
+ * It selects the specialization of the slot logic that fits the configuration:
+ * the specialized versions give the same results as the generic one.
+ */
+void Transmitter::selectSlotHandlers() {
+
+    bool single_channel = (local_channel_size == 1);
+    bool always_transmit = (bernoullian_prob >= 1);
+
+    if (single_channel && always_transmit)
+        beep_handler = &Transmitter::handleBeepMessage<true, true>;
+    else if (single_channel)
+        beep_handler = &Transmitter::handleBeepMessage<true, false>;
+    else if (always_transmit)
+        beep_handler = &Transmitter::handleBeepMessage<false, true>;
+    else
+        beep_handler = &Transmitter::handleBeepMessage<false, false>;
+
+    if (single_channel)
+        cd_handler = &Transmitter::handleCDMessage<true>;
+    else
+        cd_handler = &Transmitter::handleCDMessage<false>;
+}
+
+template<bool SINGLE_CHANNEL, bool ALWAYS_TRANSMIT>
 void Transmitter::handleBeepMessage() {
 
     if (!queue.isEmpty()) {
@@ -189,8 +439,7 @@ void Transmitter::handleBeepMessage() {
         // New packet
         if (get_extracted_channel() == -1) {
 
-            //Uniform returns a value between 0(included) and local_channel_size EXCLUDED therefore not returnable
-            int extracted_channel = uniform(0, local_channel_size);
+            int extracted_channel = extractChannel<SINGLE_CHANNEL>();
 
             EV << "EXTRACTED CHANNEL: " << extracted_channel << endl;
 
@@ -198,7 +447,7 @@ void Transmitter::handleBeepMessage() {
             set_extracted_channel(extracted_channel);
 
             // Once the channel is choosen try to transmit the packet.
-            transmit(packet_to_send);
+            transmit<SINGLE_CHANNEL, ALWAYS_TRANSMIT>(packet_to_send);
         }
 
         else {
@@ -217,7 +466,7 @@ void Transmitter::handleBeepMessage() {
                 // slot_to_wait = 0 :
                 // - test the bernoullian variable to transmit and try to transmit the packet.
 
-                transmit(packet_to_send);
+                transmit<SINGLE_CHANNEL, ALWAYS_TRANSMIT>(packet_to_send);
 
             }
 
@@ -234,24 +483,28 @@ void Transmitter::handleBeepMessage() {
 
     EV << "SLOT NUMBER: " << slot_counter << endl;
 
-    // If I am the chosen one, then do my duty
-    if (par("choosen_one"))
+    // If I am the chosen one, then do my duty: with the message-based medium the medium does it.
+    if (par("choosen_one") && !message_medium)
         sendClearBeep();
 
     // GATHERING SIGNAL:
     // - QUEUE DIMENSION PER SLOT TIME
     emit(queue_dimension_per_slot_time_signal, queue.getLength());
 
+    if (simTime() > getSimulation()->getWarmupPeriod())
+        RunSummary::collectQueueLength(queue.getLength());
+
     // - TRANSMITTER's THROUGHPUT
     double tr_th = sent_packets/(double)slot_counter;
     emit(transmitter_throughput_signal,tr_th);
 
 }
 
+template<bool SINGLE_CHANNEL>
 void Transmitter::handleCDMessage() {
 
     Packet* packet_to_check = check_and_cast<Packet*>(queue.front());
-    collisionDetection(packet_to_check);
+    collisionDetection<SINGLE_CHANNEL>(packet_to_check);
 }
 
 /*
@@ -264,26 +517,50 @@ void Transmitter::handleClearMessage() {
 
     EV << "SLOT: " << slot_counter << endl;
 
-    for (int i = 0; i < local_channel_size; i++) {
+    if (background_attempts)
+        countBackgroundSuccesses();
 
-        double th_i = ((double) channel_successful_slot_counter_array[i])
-                / ((double) slot_counter);
+    // Drop data before the warm-up period
+    double total_th = cluster->channelThroughput(slot_counter, simTime() > getSimulation()->getWarmupPeriod());
 
-        EV << "THROUGHPUT [" << i << "] " << th_i << endl;
+    // Publish the live metrics every live_metrics_period slots.
+    if (live_metrics_period > 0 && slot_counter % live_metrics_period == 0)
+        live_metrics.publish(SIMTIME_DBL(simTime()), slot_counter, getSimulation()->getEventNumber(),
+                total_th, transmitter_size);
 
-        // Drop data before the warm-up period
-        if(simTime() > getSimulation()->getWarmupPeriod())
-            emit(channel_throughput_array[i], th_i);
-    }
+    // Sample the memory accounting every memory_sample_period slots.
+    if (memory_sample_period > 0 && slot_counter % memory_sample_period == 0)
+        sampleMemory();
+
+    // Record the state of the channels before clearing them.
+    if (channel_trace.isOpen())
+        recordChannelActivity();
+
+    // Adaptive warm-up: the warm-up period ends when the queues have settled.
+    if (adaptive_warmup && !warmed_up)
+        checkAdaptiveWarmup();
+
+    // The warm-up is over: take a snapshot of the counters.
+    if (!warmed_up && simTime() > getSimulation()->getWarmupPeriod())
+        endWarmup();
+
+    // Attempt rate of the population and transmissions of the background in the next slot.
+    if (background_attempts)
+        updateMeanField();
 
     clearChannels();
 
+    // Nobody has a packet: the clock can jump to the next arrival.
+    if (fast_forward && cluster->busy_transmitters == 0)
+        fastForward();
+
     EV << "CLEARED BEEP" << endl;
 }
 
 /**
  * Each transmitter has to handle its own packet when a collision occurs.
  */
+template<bool SINGLE_CHANNEL>
 void Transmitter::collisionDetection(Packet* p) {
 
     //EV << "CHECKING FOR A COLLISION ON CHANNEL " << get_extracted_channel()<< endl;
@@ -291,10 +568,23 @@ void Transmitter::collisionDetection(Packet* p) {
     int transmission_number_per_channel = 0;
 
     //Check there is just once transmitter who sends into the current slot
-    for (int i = 0; i < transmitter_size; i++) {
-        transmission_number_per_channel += channels[i * local_channel_size
-                + get_extracted_channel()];    //If 1 adds a contribute, if 0 no
+    if (message_medium) {
+        transmission_number_per_channel = medium_transmissions;
     }
+    else if (SINGLE_CHANNEL) {
+        for (int i = 0; i < transmitter_size; i++)
+            transmission_number_per_channel += channels[i];
+    }
+    else {
+        for (int i = 0; i < transmitter_size; i++) {
+            transmission_number_per_channel += channels[i * local_channel_size
+                    + get_extracted_channel()];    //If 1 adds a contribute, if 0 no
+        }
+    }
+
+    // Mean-field mode: the rest of the population shares the channel.
+    if (background_attempts)
+        transmission_number_per_channel += background_attempts[get_extracted_channel()];
 
     print_channel_matrix();
 
@@ -308,6 +598,9 @@ void Transmitter::collisionDetection(Packet* p) {
         // Increment the number of collisions generated by that packet.
         increment_collision_number();
 
+        PROFILE_COUNT(PROFILE_COLLISIONS, 1);
+        PROFILE_COUNT(PROFILE_BACKOFF_SLOTS, slot_to_wait);
+
         EV << "BACKOFF: " << slot_to_wait << endl;
         EV << "COLLISION NUMBER: " << get_collision_number() << endl;
     }
@@ -321,12 +614,22 @@ void Transmitter::collisionDetection(Packet* p) {
         if (!queue.isEmpty() && get_extracted_channel() != -1) {
 
             Packet* packet = check_and_cast<Packet*>(queue.pop());
+            memoryPacketDequeued();
+            cluster->queued_packets--;
+            packet->setCollision_number(get_collision_number());
             send(packet, "channel_array", get_extracted_channel());
 
+            LiveMetrics::packetDequeued();
+
+            if (queue.isEmpty())
+                cluster->busy_transmitters--;
+
         }
 
-        // Increment the number of slots in which there has been a success for the interested channel.
-        channel_successful_slot_counter_array[get_extracted_channel()]++;
+        // Increment the number of slots in which there has been a success for the interested channel
+        // ( the medium counts them in the message-based mode ).
+        if (!message_medium)
+            channel_successful_slot_counter_array[get_extracted_channel()]++;
 
         // Increment the number of sent packets.
         sent_packets++;
@@ -356,25 +659,48 @@ void Transmitter::handlePacketMessage(cMessage* msg) {
     Packet* received_packet = check_and_cast<Packet*>(msg);
 
     // Insert the arrived packet in the BACK of the queue
+    if (queue.isEmpty())
+        cluster->busy_transmitters++;
+
+    // Importance sampling: a packet that finds the queue empty is a probe.
+    if (importance_tagged && queue.isEmpty())
+        received_packet->setImportance_probe(true);
+
     queue.insert(received_packet);
+    memoryPacketQueued();
+    cluster->queued_packets++;
+
+    LiveMetrics::packetQueued();
 
     //EV << "TRANSMITTER ID: " << this->getId() << "   QUEUE DIMENSION:   "<< queue.getLength() << endl;
 }
 
+template<bool SINGLE_CHANNEL, bool ALWAYS_TRANSMIT>
 void Transmitter::transmit(Packet* p) {
 
     // Test the bernoullian variable: if "true" try to transmit, otherwise be quite.
-    if (bernoullianTest()) {
+    if (bernoullianTest<ALWAYS_TRANSMIT>()) {
 
         EV << "BERNOULLIAN TEST: SUCCESS   ON CHANNEL "
                   << get_extracted_channel() << endl;
 
         //Increment the transmission number over this channel
-        channels[id * local_channel_size + get_extracted_channel()]++;
+        if (message_medium) {
+            send(new cMessage(MEDIUM_ATTEMPT_NAME, get_extracted_channel()), "medium_out");
+            memoryAllocated(MEMORY_CONTROL_MESSAGES, sizeof(cMessage));
+        }
+        else if (SINGLE_CHANNEL)
+            channels[id]++;
+        else
+            channels[id * local_channel_size + get_extracted_channel()]++;
 
-        // Update the time at which the packet has been sent.
+        // Update the time at which the packet has been sent: the beep of slot k ( counted from 1 )
+        // comes at k * slot_time, before slot_counter is incremented.
 
-        p->setTransmission_time(SIMTIME_DBL(simTime()));
+        if (slot_time_domain)
+            p->setTransmission_slot(slot_counter + 1);
+        else
+            p->setTransmission_time(SIMTIME_DBL(simTime()));
 
         /*
          * it checks for a collision whenever a transmitter tries to transmit a packet into a certain slot
@@ -393,26 +719,95 @@ void Transmitter::transmit(Packet* p) {
 
 /* PROBABILITY FUNCTIONS */
 
+/**
+ * It extracts the channel for a new packet.
+ * With a single channel there is nothing to extract: the draw is only skipped,
+ * so that a shared RNG produces the same sequence as the generic version.
+ */
+template<bool SINGLE_CHANNEL>
+int Transmitter::extractChannel() {
+
+    if (SINGLE_CHANNEL) {
+        random_streams.skipDraw(CHANNEL_STREAM);
+        return 0;
+    }
+
+    // Weighted channels: one uniform number, as in the uniform case, through the alias table.
+    if (channel_table)
+        return channel_table->sample(random_streams.uniform(CHANNEL_STREAM, 0, 1));
+
+    //Uniform returns a value between 0(included) and local_channel_size EXCLUDED therefore not returnable
+    return random_streams.uniform(CHANNEL_STREAM, 0, local_channel_size);
+}
+
 /**
  * It extracts a Bernoullian probability.
  * It returns:
  * - true: if the value is equal to 1
  * - false: otherwise
  */
+template<bool ALWAYS_TRANSMIT>
 bool Transmitter::bernoullianTest() {
 
-    return (bernoulli(bernoullian_prob) == 1) ? true : false;
+    PROFILE_COUNT(PROFILE_BERNOULLI_DRAWS, 1);
+
+    if (ALWAYS_TRANSMIT) {
+        random_streams.skipDraw(BERNOULLI_STREAM);
+        return true;
+    }
+
+    // Importance sampling: biased test, weighted by the likelihood ratio.
+    Packet* probe = (importance_prob >= 0) ? importanceProbe() : 0;
+
+    if (probe) {
+
+        bool success = random_streams.bernoulli(BERNOULLI_STREAM, importance_prob);
+
+        probe->setLikelihood_ratio(probe->getLikelihood_ratio()
+                * (success ? bernoullian_prob / importance_prob : (1 - bernoullian_prob) / (1 - importance_prob)));
+
+        return success;
+    }
+
+    return random_streams.bernoulli(BERNOULLI_STREAM, bernoullian_prob);
 }
 
 int Transmitter::backoffCalculator(int collision_number) {
 
     double range = pow(2, (collision_number + 1));
     EV << "BACKOFF RANGE: " << "[  1  ;  " << range << "  ]" << endl;
-    int time_to_wait = (int) uniform(1, range);
+
+    // Importance sampling: tilted backoff, weighted by the likelihood ratio.
+    Packet* probe = (importance_tilt != 1) ? importanceProbe() : 0;
+
+    if (probe) {
+
+        double likelihood_ratio = probe->getLikelihood_ratio();
+        int time_to_wait = tiltedBackoff(random_streams.uniform(BACKOFF_STREAM, 0, 1), collision_number + 1,
+                importance_tilt, likelihood_ratio);
+        probe->setLikelihood_ratio(likelihood_ratio);
+
+        return time_to_wait;
+    }
+
+    int time_to_wait = random_streams.backoff(BACKOFF_STREAM, collision_number + 1);
 
     return time_to_wait;
 }
 
+/**
+ * The packet at the head of the queue, if this is the tagged transmitter and the packet is a probe.
+ */
+Packet* Transmitter::importanceProbe() {
+
+    if (!importance_tagged || queue.isEmpty())
+        return 0;
+
+    Packet* head = check_and_cast<Packet*>(queue.front());
+
+    return head->getImportance_probe() ? head : 0;
+}
+
 /* DEBUG FUNCTION: It prints the status of the channels. */
 
 void Transmitter::print_channel_matrix() {
@@ -425,6 +820,426 @@ void Transmitter::print_channel_matrix() {
     }
 }
 
+/* FAST-FORWARD */
+
+/**
+ * The chosen one, at the end of a slot in which every queue is empty, moves the slot clock of every
+ * transmitter to the last slot that begins before the next arrival: the skipped slots would have
+ * changed nothing but the counters.
+ * The jump stops before the slot whose clear ends the warm-up period, so the snapshot of the
+ * counters is taken as without fast-forward.
+ */
+void Transmitter::fastForward() {
+
+    simtime_t slot_time = getParentModule()->par("slot_time").doubleValue();
+    int64_t slot_raw = SIMTIME_RAW(slot_time);
+    int64_t next_arrival = -1;
+
+    for (size_t i = 0; i < generators.size(); i++) {
+
+        simtime_t arrival;
+        if (generators[i]->nextArrivalTime(arrival) && (next_arrival < 0 || SIMTIME_RAW(arrival) < next_arrival))
+            next_arrival = SIMTIME_RAW(arrival);
+    }
+
+    // No more arrivals ( e.g. the replayed traces are over ): nothing to jump to.
+    if (next_arrival < 0)
+        return;
+
+    // Last slot that begins strictly before the next arrival.
+    int64_t last_idle_slot = (next_arrival - 1) / slot_raw;
+
+    if (!warmed_up) {
+
+        // Slot whose clear is the first one after the warm-up period.
+        simtime_t clear_time = getParentModule()->par("clear_time").doubleValue();
+        int64_t warmup_slot = (SIMTIME_RAW(getSimulation()->getWarmupPeriod()) - SIMTIME_RAW(clear_time)) / slot_raw + 1;
+
+        if (last_idle_slot > warmup_slot - 1)
+            last_idle_slot = warmup_slot - 1;
+    }
+
+    int64_t slots = last_idle_slot - slot_counter;
+    if (slots <= 0)
+        return;
+
+    if (slots > INT_MAX - slot_counter)
+        slots = INT_MAX - slot_counter;
+
+    EV << "FAST-FORWARD: " << slots << " IDLE SLOTS" << endl;
+
+    if (channel_trace.isOpen())
+        channel_trace.recordIdleSlots(slots);
+
+    for (size_t i = 0; i < transmitters.size(); i++)
+        transmitters[i]->skipIdleSlots((int) slots);
+}
+
+/**
+ * The next slot beep is delayed by "slots" slots and the slot counter advances as if they had passed:
+ * every throughput is measured over them. The queue length of the skipped slots, always 0, still
+ * counts in the run summary and in the queue length vector, stamped now, so that its mean is the same
+ * as without the jump; the throughput vector has no samples for them.
+ */
+void Transmitter::skipIdleSlots(int slots) {
+
+    Enter_Method_Silent();
+
+    simtime_t slot_time = getParentModule()->par("slot_time").doubleValue();
+    simtime_t next_beep = slotBeep->getArrivalTime() + slot_time * slots;
+
+    cancelEvent(slotBeep);
+    scheduleAt(next_beep, slotBeep);
+
+    slot_counter += slots;
+
+    if (simTime() > getSimulation()->getWarmupPeriod())
+        RunSummary::collectIdleSlots(slots);
+
+    // The jump never crosses the end of the warm-up period: the samples fall on the same side as their slots.
+    if (mayHaveListeners(queue_dimension_per_slot_time_signal))
+        for (int k = 0; k < slots; k++)
+            emit(queue_dimension_per_slot_time_signal, 0);
+}
+
+/* MEAN-FIELD MODE */
+
+/**
+ * A slot in which only one transmitter of the background transmits is a success of the channel,
+ * even if no transmitter of the sample sees it.
+ */
+void Transmitter::countBackgroundSuccesses() {
+
+    for (int j = 0; j < local_channel_size; j++) {
+
+        if (background_attempts[j] != 1)
+            continue;
+
+        bool tagged_attempt = false;
+        for (int i = 0; i < transmitter_size && !tagged_attempt; i++)
+            tagged_attempt = (channels[i * local_channel_size + j] != 0);
+
+        if (!tagged_attempt)
+            channel_successful_slot_counter_array[j]++;
+    }
+}
+
+/**
+ * The attempt rate q of each channel is the fraction of the sample that transmitted on it,
+ * smoothed over about mean_field_window slots. The K = population - N background transmitters
+ * are assumed independent and alike the sample: in the next slot nobody of them transmits
+ * with probability (1-q)^K, exactly one with probability K q (1-q)^(K-1).
+ */
+void Transmitter::updateMeanField() {
+
+    double background = population - transmitter_size;
+
+    for (int j = 0; j < local_channel_size; j++) {
+
+        int attempts = 0;
+        for (int i = 0; i < transmitter_size; i++)
+            attempts += channels[i * local_channel_size + j];
+
+        double& q = cluster->attempt_rate[j];
+        q += mean_field_alpha * (attempts / (double) transmitter_size - q);
+
+        double p0 = (q < 1) ? exp(background * log1p(-q)) : 0;
+        double p1 = (q < 1) ? background * q * p0 / (1 - q) : 0;
+
+        double u = random_streams.uniform(MEAN_FIELD_STREAM, 0, 1);
+        background_attempts[j] = (u < p0) ? 0 : (u < p0 + p1) ? 1 : 2;
+    }
+}
+
+/**
+ * Error bound of the mean-field throughput, recorded for each channel: the sampling error of q
+ * ( standard deviation sqrt(q(1-q)/N * alpha/(2-alpha)) for the smoothed estimate ) propagated through
+ * the throughput of the population S(q) = M q (1-q)^(M-1), at 95%.
+ * It does not include the error of the independence assumption, which vanishes as M grows.
+ */
+void Transmitter::recordMeanFieldBound() {
+
+    for (int j = 0; j < local_channel_size; j++) {
+
+        double q = cluster->attempt_rate[j];
+        double sigma = sqrt(q * (1 - q) / transmitter_size * mean_field_alpha / (2 - mean_field_alpha));
+        double slope = (q < 1) ? population * exp((population - 2) * log1p(-q)) * (1 - population * q) : 0;
+
+        char name[64];
+
+        sprintf(name, "mean_field_attempt_rate%d", j);
+        recordScalar(name, q);
+
+        sprintf(name, "mean_field_throughput_error%d", j);
+        recordScalar(name, 1.96 * fabs(slope) * sigma);
+    }
+}
+
+/* END OF THE WARM-UP PERIOD */
+
+/**
+ * The chosen one takes a snapshot of the channels' counters: the throughput after the warm-up period
+ * is measured from here. Then it forks the replicas that will share the warm state.
+ */
+void Transmitter::endWarmup() {
+
+    warmed_up = true;
+    warm_slot_counter = slot_counter;
+    warm_successful_slot_counter.assign(channel_successful_slot_counter_array,
+            channel_successful_slot_counter_array + local_channel_size);
+
+    // The replicas measure queue length and delay from the fork, as the throughput.
+    if (fork_replicas > 1) {
+        RunSummary::reset();
+        forkFromWarmState();
+    }
+}
+
+/**
+ * At the end of every window of adaptive_warmup_window slots the mean number of queued packets is compared
+ * with the one of the previous window: when they agree within adaptive_warmup_tolerance the warm-up period
+ * of the simulation is moved to now, so that the recorders and the model start collecting from the next slot.
+ */
+void Transmitter::checkAdaptiveWarmup() {
+
+    window_queued_packets += cluster->queued_packets;
+    window_slots++;
+
+    if (window_slots < adaptive_warmup_window)
+        return;
+
+    double window_mean = window_queued_packets / window_slots;
+
+    if (previous_window_mean >= 0 && simTime() < getSimulation()->getWarmupPeriod()) {
+
+        double scale = std::max(1.0, std::max(window_mean, previous_window_mean));
+
+        if (fabs(window_mean - previous_window_mean) <= adaptive_warmup_tolerance * scale) {
+
+            EV << "WARM-UP OVER AFTER " << slot_counter << " SLOTS" << endl;
+            getSimulation()->setWarmupPeriod(simTime());
+        }
+    }
+
+    previous_window_mean = window_mean;
+    window_queued_packets = 0;
+    window_slots = 0;
+}
+
+/**
+ * The throughput of each channel gathered after the warm-up period,
+ * followed by the throughput of the whole system.
+ */
+std::vector<double> Transmitter::postWarmupThroughput() {
+
+    std::vector<double> results;
+    double slots = slot_counter - warm_slot_counter;
+    double total_th = 0;
+
+    for (int i = 0; i < local_channel_size; i++) {
+
+        double th_i = 0;
+        if (warmed_up && slots > 0)
+            th_i = (channel_successful_slot_counter_array[i] - warm_successful_slot_counter[i]) / slots;
+
+        results.push_back(th_i);
+        total_th += th_i;
+    }
+
+    results.push_back(total_th);
+
+    return results;
+}
+
+/* WARM-START CONTINUATION */
+
+/**
+ * It refills the queue with the packets left by the previous run, stamped as generated as long ago as their
+ * age, so that their delays include the time they had already waited, and gives the head packet its backoff
+ * stage, its wait and its channel. The generator needs no retiming: the interarrival times are exponential,
+ * so it starts afresh with the new mean.
+ */
+void Transmitter::restoreWarmState() {
+
+    const WarmState& state = cluster->warm_states[id];
+    double slot_time = getParentModule()->par("slot_time").doubleValue();
+
+    for (int k = 0; k < state.queue_length; k++) {
+
+        // Generated before the beginning of this run: the times are negative.
+        double generation_time = SIMTIME_DBL(simTime()) - state.ages[k];
+        double generation_slot = floor(generation_time / slot_time);
+
+        // Accounted as the generator and the enqueue path do, so that the dequeue balances it.
+        Packet* packet = new Packet(packetName);
+        memoryAllocated(MEMORY_PENDING_PACKETS, sizeof(Packet));
+        packet->setGeneration_time(generation_time);
+        packet->setGeneration_slot((int64_t) generation_slot);
+        packet->setGeneration_offset(generation_time / slot_time - generation_slot);
+
+        queue.insert(packet);
+        memoryPacketQueued();
+        LiveMetrics::packetQueued();
+    }
+
+    cluster->queued_packets += state.queue_length;
+
+    if (state.queue_length > 0) {
+
+        cluster->busy_transmitters++;
+
+        collision_number_per_packet = state.collision_number;
+        slot_to_wait = state.slot_to_wait;
+        extracted_channel = state.extracted_channel;
+    }
+}
+
+void Transmitter::storeWarmState() {
+
+    WarmState& state = cluster->warm_states[id];
+
+    state.queue_length = queue.getLength();
+    state.collision_number = collision_number_per_packet;
+    state.slot_to_wait = slot_to_wait;
+    state.extracted_channel = extracted_channel;
+
+    // Age of every queued packet, in the time domain of its stamps.
+    double slot_time = getParentModule()->par("slot_time").doubleValue();
+    state.ages.clear();
+
+    for (int k = 0; k < queue.getLength(); k++) {
+
+        Packet* packet = check_and_cast<Packet*>(queue.get(k));
+
+        double generation_time = slot_time_domain
+                ? (packet->getGeneration_slot() + packet->getGeneration_offset()) * slot_time
+                : packet->getGeneration_time();
+
+        state.ages.push_back(std::max(0.0, SIMTIME_DBL(simTime()) - generation_time));
+    }
+}
+
+/* FORK-FROM-WARM-STATE REPLICATIONS */
+
+/**
+ * The chosen one forks the whole process once the warm-up period is over:
+ * all the replicas start from the same warm state and continue with their own seed-set.
+ */
+void Transmitter::forkFromWarmState() {
+
+    int replica = replica_fork.forkReplicas(fork_replicas);
+
+    EV << "FORKED REPLICA: " << replica << " OF " << fork_replicas << endl;
+}
+
+/**
+ * Results of a replica: the throughput of each channel and in total, then the mean queue length,
+ * the mean delay and the delivered packets gathered by the run summary after the fork.
+ */
+std::vector<double> Transmitter::replicaResults() {
+
+    std::vector<double> results = postWarmupThroughput();
+
+    results.push_back((RunSummary::queue_length_samples > 0)
+            ? RunSummary::queue_length_sum / RunSummary::queue_length_samples : 0.0);
+    results.push_back((RunSummary::delivered_packets > 0)
+            ? RunSummary::delay_sum / RunSummary::delivered_packets : 0.0);
+    results.push_back(RunSummary::delivered_packets);
+
+    return results;
+}
+
+/**
+ * The parent collects the results of all the replicas and records their mean and standard deviation.
+ */
+void Transmitter::mergeReplicaResults() {
+
+    std::vector< std::vector<double> > results = replica_fork.collect();
+    results.insert(results.begin(), replicaResults());
+
+    int values = local_channel_size + 4;
+
+    for (int j = 0; j < values; j++) {
+
+        cStdDev stat;
+
+        for (size_t r = 0; r < results.size(); r++)
+            if ((int) results[r].size() == values)
+                stat.collect(results[r][j]);
+
+        char name[64];
+        if (j < local_channel_size)
+            sprintf(name, "fork_channel_throughput%d", j);
+        else if (j == local_channel_size)
+            sprintf(name, "fork_total_throughput");
+        else if (j == local_channel_size + 1)
+            sprintf(name, "fork_mean_queue_length");
+        else if (j == local_channel_size + 2)
+            sprintf(name, "fork_mean_delay");
+        else
+            sprintf(name, "fork_delivered_packets");
+
+        recordScalar((std::string(name) + ":mean").c_str(), stat.getMean());
+        recordScalar((std::string(name) + ":stddev").c_str(), stat.getStddev());
+
+        if (j == 0)
+            recordScalar("fork_replicas", stat.getCount());
+    }
+}
+
+/* PARAMETER SWEEP */
+
+/**
+ * The chosen one appends the summary of the run to the file shared by all the runs of the sweep.
+ */
+void Transmitter::appendRunSummary() {
+
+    const char* summary_file = getParentModule()->par("sweep_summary_file").stringValue();
+
+    if (strlen(summary_file) == 0)
+        return;
+
+    RunSummaryPoint point;
+    point.transmitter_size = transmitter_size;
+    point.channel_size = local_channel_size;
+    point.exponential_send_mean_time = getParentModule()->getSubmodule("generator_array", 0)->par("exponential_send_mean_time");
+    point.bernoullian_prob = bernoullian_prob;
+    point.repetition = atoi(getEnvir()->getConfigEx()->getVariable("repetition"));
+
+    if (!RunSummary::append(summary_file, point, postWarmupThroughput().back()))
+        throw cRuntimeError("Cannot append the run summary to %s", summary_file);
+}
+
+/* It records into the trace the number of transmissions on each channel during the current slot. */
+
+void Transmitter::recordChannelActivity() {
+
+    for (int j = 0; j < local_channel_size; j++) {
+
+        channel_attempts[j] = 0;
+        for (int i = 0; i < transmitter_size; i++)
+            channel_attempts[j] += channels[i * local_channel_size + j];
+
+        if (background_attempts)
+            channel_attempts[j] += background_attempts[j];
+    }
+
+    channel_trace.recordSlot(&channel_attempts[0]);
+}
+
+/**
+ * It records the bytes of each category of the memory accounting and their total.
+ */
+void Transmitter::sampleMemory() {
+
+    int64_t total = sampleMemoryAccounting(getSimulation());
+
+    for (int c = 0; c < MEMORY_CATEGORY_NUMBER; c++)
+        memory_bytes_vectors[c].record(memory_accounting.accounts[c].bytes);
+
+    memory_total_vector.record(total);
+}
+
 // Packet's support functions
 
 void Transmitter::clear_packet_variables() {
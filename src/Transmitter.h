@@ -21,21 +21,18 @@
 
 #include "Utility"
 #include "Packet_m.h"
+#include "ChannelTrace.h"
+#include "LiveMetrics.h"
+#include "Profiling.h"
+#include "RandomStreams.h"
+#include "ReplicaFork.h"
+#include "RunSummary.h"
+#include "TransmitterCluster.h"
+#include "ImportanceSampling.h"
+#include "MemoryAccounting.h"
 using namespace omnetpp;
 
-
-// It allows to assign an ID to each Transmitter.
-
-static int id_number = 0;
-
-// Global variables:
-// - array of integers: it takes into account the number of transmitters involved in a communication on a certain channel
-// - array of integers: it supports the signal below.
-// - array of signals:  it records the throughput of each channel.
-
-int *channels = 0;
-int *channel_successful_slot_counter_array = 0;
-simsignal_t* channel_throughput_array = 0;
+class Generator;
 
 // Class.
 
@@ -44,6 +41,9 @@ public:
     Transmitter();
     virtual ~Transmitter();
 
+    // Fast-forward: the slot clock jumps over "slots" idle slots.
+    void skipIdleSlots(int slots);
+
 protected:
 
    // Self sent messages:
@@ -56,16 +56,45 @@ protected:
 
     cQueue queue;
 
-    int id;                             //  Identifier of each transmitter
+    int id;                             //  Identifier of each transmitter: its index in the cluster
     int slot_to_wait;                   //  Slot number to wait before trying to transmit
     int local_channel_size;             //  Number of channels for the actual transmitter
+    const AliasTable *channel_table;    //  Non-uniform channel selection, shared by the cluster ( 0: uniform )
     int transmitter_size;               //  Whole number of transmitters
     int slot_counter;                   //  Counter that increments each time a new slot-time occurs
+    bool slot_time_domain;              //  Packets are stamped with slot indices instead of times
 
     int extracted_channel;              //  The channel that has been extracted to send the current packet
     int collision_number_per_packet;    //  The number of collisions caused by the current packet
     double bernoullian_prob;
 
+    RandomStreams random_streams;       //  Streams for channel extraction, bernoullian test and backoff
+
+    // Shared variables, owned by the cluster of this network:
+    // - matrix of the transmissions on each channel [ transmitter * channel ].
+    // - number of slots with a success on each channel.
+
+    TransmitterCluster *cluster;
+    int *channels;
+    int *channel_successful_slot_counter_array;
+
+    // Mean-field mode: transmissions of the background population ( 0 if the mode is off ),
+    // its size and the smoothing factor of the attempt rate estimate.
+    int *background_attempts;
+    int population;
+    double mean_field_alpha;
+
+    // Message-based medium: the attempts go to the Medium module and the verdict brings
+    // the number of transmissions on the channel of the last attempt.
+    bool message_medium;
+    int medium_transmissions;
+
+    // Importance sampling: this is the tagged transmitter, biased probability of the bernoullian test
+    // ( negative: not biased ) and tilt of the backoff ( 1: not biased ) for its probe packets.
+    bool importance_tagged;
+    double importance_prob;
+    double importance_tilt;
+
     // Variables for statistics:
     // - queue dimension per slot time.
     // - throughput of the transmitter.
@@ -75,6 +104,52 @@ protected:
     simsignal_t transmitter_throughput_signal;
     double sent_packets;
 
+    // Per-slot channel activity trace [ only for the chosen one ].
+
+    ChannelTraceWriter channel_trace;
+    std::vector<int> channel_attempts;
+
+    // Live metrics published every live_metrics_period slots [ only for the chosen one ].
+
+    LiveMetrics live_metrics;
+    int live_metrics_period;
+
+    // Memory accounting [ only for the chosen one ]: bytes of each category every memory_sample_period slots.
+
+    bool memory_accounting_enabled;
+    int memory_sample_period;
+    cOutVector memory_bytes_vectors[MEMORY_CATEGORY_NUMBER];
+    cOutVector memory_total_vector;
+
+    // State of the channels' counters at the end of the warm-up period [ only for the chosen one ].
+
+    bool warmed_up;
+    int warm_slot_counter;
+    std::vector<int> warm_successful_slot_counter;
+
+    // Adaptive warm-up [ only for the chosen one ]: mean number of queued packets over the current
+    // window of adaptive_warmup_window slots and over the previous one ( negative: none yet ).
+
+    bool adaptive_warmup;
+    int adaptive_warmup_window;
+    double adaptive_warmup_tolerance;
+    double window_queued_packets;
+    int window_slots;
+    double previous_window_mean;
+
+    // Fork-from-warm-state replications [ only for the chosen one ]:
+    // number of replicas to fork at the end of the warm-up period.
+
+    int fork_replicas;
+    ReplicaFork replica_fork;
+
+    // Fast-forward over globally idle periods [ only for the chosen one ]:
+    // the modules whose next events decide how far the slot clock can jump.
+
+    bool fast_forward;
+    std::vector<Transmitter*> transmitters;
+    std::vector<Generator*> generators;
+
 protected:
 
     virtual void initialize();
@@ -94,19 +169,52 @@ protected:
     int get_collision_number();
 
     // Handle functions
-    void handleBeepMessage();
-    void handleCDMessage();
+    // The slot logic is specialized at compile time on the regime, selected at initialization:
+    // - SINGLE_CHANNEL: C = 1, the channel is always 0 and the channel matrix is a plain array.
+    // - ALWAYS_TRANSMIT: p = 1 ( e.g. C >= N ), the bernoullian test always succeeds.
+    void (Transmitter::*beep_handler)();
+    void (Transmitter::*cd_handler)();
+
+    template<bool SINGLE_CHANNEL, bool ALWAYS_TRANSMIT> void handleBeepMessage();
+    template<bool SINGLE_CHANNEL> void handleCDMessage();
     void handleClearMessage();
     void handlePacketMessage( cMessage* msg );
 
-    void transmit( Packet* p );
-    void collisionDetection ( Packet* p );  //It checks if a collision occurs on a certain channel
+    template<bool SINGLE_CHANNEL, bool ALWAYS_TRANSMIT> void transmit( Packet* p );
+    template<bool SINGLE_CHANNEL> void collisionDetection ( Packet* p );  //It checks if a collision occurs on a certain channel
     void clearChannels();
 
-    bool bernoullianTest();
+    void selectSlotHandlers();
+    template<bool SINGLE_CHANNEL> int extractChannel();
+    template<bool ALWAYS_TRANSMIT> bool bernoullianTest();
     int backoffCalculator( int collision_number );
+    Packet* importanceProbe();
 
     void print_channel_matrix();
+    void recordChannelActivity();
+    void sampleMemory();
+
+    void endWarmup();
+    void checkAdaptiveWarmup();
+
+    // Warm-start continuation
+    void restoreWarmState();
+    void storeWarmState();
+    std::vector<double> postWarmupThroughput();
+
+    // Fork-from-warm-state replications
+    void forkFromWarmState();
+    std::vector<double> replicaResults();
+    void mergeReplicaResults();
+
+    void appendRunSummary();
+
+    void fastForward();
+
+    // Mean-field mode [ only for the chosen one ]
+    void countBackgroundSuccesses();
+    void updateMeanField();
+    void recordMeanFieldBound();
 
 };
 
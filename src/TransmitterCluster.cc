@@ -0,0 +1,245 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#include "TransmitterCluster.h"
+#include "MemoryAccounting.h"
+
+#include <stdio.h>
+#include <string.h>
+
+Define_Module(TransmitterCluster);
+
+TransmitterCluster::TransmitterCluster() {
+
+    transmitter_size = 0;
+    channel_size = 0;
+
+    channels = 0;
+    channel_successful_slot_counter_array = 0;
+    busy_transmitters = 0;
+    queued_packets = 0;
+    warm_started = false;
+
+    population = 0;
+    attempt_rate = 0;
+    background_attempts = 0;
+}
+
+TransmitterCluster::~TransmitterCluster() {
+
+    release();
+}
+
+void TransmitterCluster::initialize() {
+
+    release();
+
+    // Memory accounting: the cluster is initialized before the modules that feed it.
+    resetMemoryAccounting();
+
+    transmitter_size = (int) par("transmitter_size");
+    channel_size = (int) par("channel_size");
+
+    int total_channel_size = channel_size * transmitter_size;
+
+    channels = new int[total_channel_size];
+    for (int i = 0; i < total_channel_size; i++)
+        channels[i] = 0;
+
+    channel_successful_slot_counter_array = new int[channel_size];
+    for (int i = 0; i < channel_size; i++)
+        channel_successful_slot_counter_array[i] = 0;
+
+    busy_transmitters = 0;
+    queued_packets = 0;
+
+    // Warm-start continuation: without a compatible state file the transmitters start empty.
+    WarmState empty_state = { 0, 0, 0, -1 };
+    warm_states.assign(transmitter_size, empty_state);
+
+    const char *warm_start_file = par("warm_start_file").stringValue();
+    warm_started = (strlen(warm_start_file) > 0) && loadWarmStates(warm_start_file);
+
+    //REGISTERING SIGNALS
+    // - Throughput for each channel: one recorder per channel, whatever the number of transmitters.
+
+    channel_throughput_array.resize(channel_size);
+    cProperty *statisticTemplate = getProperties()->get("statisticTemplate", "channel_throughput_signal");
+
+    for (int i = 0; i < channel_size; i++) {
+
+        char signalName[32];
+        sprintf(signalName, "channel_throughput%d", i);
+
+        channel_throughput_array[i] = registerSignal(signalName);
+        getEnvir()->addResultRecorders(this, channel_throughput_array[i], signalName, statisticTemplate);
+    }
+
+    // Mean-field mode: the rest of the population starts silent, its attempt rate is learnt from the sample.
+    population = (int) par("mean_field_population");
+
+    if (population > 0) {
+
+        if (population <= transmitter_size)
+            throw cRuntimeError("mean_field_population (%d) must be larger than transmitter_size (%d)", population, transmitter_size);
+
+        attempt_rate = new double[channel_size];
+        background_attempts = new int[channel_size];
+
+        for (int i = 0; i < channel_size; i++) {
+            attempt_rate[i] = 0;
+            background_attempts[i] = 0;
+        }
+    }
+
+    int shared_arrays = (population > 0) ? 4 : 2;
+    setMemoryAccount(MEMORY_SHARED_STATE, shared_arrays, (total_channel_size + channel_size) * sizeof(int)
+            + ((population > 0) ? channel_size * (sizeof(double) + sizeof(int)) : 0));
+}
+
+void TransmitterCluster::release() {
+
+    delete[] channels;
+    delete[] channel_successful_slot_counter_array;
+
+    delete[] attempt_rate;
+    delete[] background_attempts;
+
+    channels = 0;
+    channel_successful_slot_counter_array = 0;
+    attempt_rate = 0;
+    background_attempts = 0;
+
+    for (std::map<std::vector<double>, AliasTable*>::iterator it = channel_tables.begin(); it != channel_tables.end(); it++)
+        delete it->second;
+    channel_tables.clear();
+}
+
+/**
+ * The transmitters have already stored their state: it is saved for the next run.
+ */
+void TransmitterCluster::finish() {
+
+    const char *warm_start_file = par("warm_start_file").stringValue();
+
+    if (strlen(warm_start_file) > 0 && !saveWarmStates(warm_start_file))
+        throw cRuntimeError("Cannot write the warm state to %s", warm_start_file);
+}
+
+/**
+ * Text file: a header with N and C, then one line per transmitter with queue length, collision number,
+ * slots to wait, extracted channel and the age of each queued packet. A missing file, one written for
+ * another N or C, or one with values out of range, is ignored.
+ */
+bool TransmitterCluster::loadWarmStates(const char *file) {
+
+    FILE *in = fopen(file, "r");
+    if (!in)
+        return false;
+
+    int file_transmitter_size, file_channel_size;
+    std::vector<WarmState> states(transmitter_size);
+    bool valid = (fscanf(in, "srawn-warm-state-2 %d %d", &file_transmitter_size, &file_channel_size) == 2)
+            && file_transmitter_size == transmitter_size && file_channel_size == channel_size;
+
+    for (int i = 0; valid && i < transmitter_size; i++) {
+
+        WarmState& state = states[i];
+        valid = (fscanf(in, "%d %d %d %d", &state.queue_length, &state.collision_number, &state.slot_to_wait,
+                &state.extracted_channel) == 4) && state.queue_length >= 0 && state.collision_number >= 0
+                && state.slot_to_wait >= 0 && state.extracted_channel >= -1 && state.extracted_channel < channel_size;
+
+        if (valid)
+            state.ages.resize(state.queue_length);
+
+        for (int k = 0; valid && k < state.queue_length; k++)
+            valid = (fscanf(in, "%lf", &state.ages[k]) == 1) && state.ages[k] >= 0;
+    }
+
+    fclose(in);
+
+    if (!valid) {
+        EV << "WARM STATE " << file << " IGNORED: IT DOES NOT MATCH THIS NETWORK" << endl;
+        return false;
+    }
+
+    warm_states = states;
+
+    return true;
+}
+
+bool TransmitterCluster::saveWarmStates(const char *file) {
+
+    FILE *out = fopen(file, "w");
+    if (!out)
+        return false;
+
+    fprintf(out, "srawn-warm-state-2 %d %d\n", transmitter_size, channel_size);
+
+    for (int i = 0; i < transmitter_size; i++) {
+
+        const WarmState& state = warm_states[i];
+        fprintf(out, "%d %d %d %d", state.queue_length, state.collision_number, state.slot_to_wait,
+                state.extracted_channel);
+
+        for (size_t k = 0; k < state.ages.size(); k++)
+            fprintf(out, " %.17g", state.ages[k]);
+
+        fprintf(out, "\n");
+    }
+
+    return fclose(out) == 0;
+}
+
+/**
+ * The alias table of the channel weights: it is built by the first transmitter that asks for
+ * these weights and shared with the others.
+ */
+const AliasTable *TransmitterCluster::channelTable(const std::vector<double>& weights) {
+
+    std::map<std::vector<double>, AliasTable*>::iterator it = channel_tables.find(weights);
+
+    if (it != channel_tables.end())
+        return it->second;
+
+    AliasTable *table = new AliasTable(weights);
+    channel_tables[weights] = table;
+
+    return table;
+}
+
+/**
+ * The throughput of each channel after "slots" slots: the slots with a success over all the slots.
+ * If "record" is true ( after the warm-up period ) it is emitted. It returns the sum over the channels.
+ */
+double TransmitterCluster::channelThroughput(int slots, bool record) {
+
+    Enter_Method_Silent();
+
+    double total_th = 0;
+
+    for (int i = 0; i < channel_size; i++) {
+
+        double th_i = ((double) channel_successful_slot_counter_array[i]) / ((double) slots);
+        total_th += th_i;
+
+        EV << "THROUGHPUT [" << i << "] " << th_i << endl;
+
+        if (record)
+            emit(channel_throughput_array[i], th_i);
+    }
+
+    return total_th;
+}
@@ -0,0 +1,95 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#ifndef __SRAWN_TRANSMITTERCLUSTER_H_
+#define __SRAWN_TRANSMITTERCLUSTER_H_
+
+#include <omnetpp.h>
+#include <map>
+#include <vector>
+
+#include "AliasTable.h"
+
+using namespace omnetpp;
+
+/**
+ * State of a transmitter carried from the end of a run to the beginning of the next one
+ * ( warm-start continuation ): its queue and the state of the packet at the head of it.
+ */
+struct WarmState {
+    int queue_length;
+    int collision_number;
+    int slot_to_wait;
+    int extracted_channel;
+    std::vector<double> ages;       //  Time already spent by each queued packet, head first [ s ]
+};
+
+/**
+ * The compound module of the transmitters: it owns the state they share, so that every network
+ * has its own and many runs can follow one another in the same process ( e.g. Cmdenv -r 0..99 ).
+ * Its initialize() is called before the one of the transmitters.
+ */
+class TransmitterCluster : public cModule
+{
+private:
+    int transmitter_size;
+    int channel_size;
+
+    // Signals: they record the throughput of each channel.
+    std::vector<simsignal_t> channel_throughput_array;
+
+    // Alias tables of the channel selection: one for each set of weights, shared by the transmitters that use it.
+    std::map<std::vector<double>, AliasTable*> channel_tables;
+
+public:
+    // Shared variables:
+    // - array of integers: it takes into account the number of transmitters involved in a communication on a certain channel
+    // - array of integers: number of slots with a success on each channel.
+    // - number of transmitters with a non-empty queue: when it is 0 the whole system is idle.
+    int *channels;
+    int *channel_successful_slot_counter_array;
+    int busy_transmitters;
+
+    // Packets in all the queues: the adaptive warm-up watches them.
+    int queued_packets;
+
+    // Warm-start continuation: state of each transmitter, loaded from warm_start_file at the beginning
+    // ( warm_started ) and filled in by the transmitters at the end, when the cluster saves it.
+    std::vector<WarmState> warm_states;
+    bool warm_started;
+
+    // Mean-field mode: the transmitters are a tagged sample of a population of mean_field_population.
+    // - attempt rate of each transmitter on each channel, estimated from the sample.
+    // - transmissions of the rest of the population on each channel in this slot ( 0, 1, 2 = more than one ).
+    int population;
+    double *attempt_rate;
+    int *background_attempts;
+
+    TransmitterCluster();
+    virtual ~TransmitterCluster();
+
+    double channelThroughput(int slots, bool record);
+    const AliasTable *channelTable(const std::vector<double>& weights);
+
+protected:
+    virtual void initialize();
+    virtual void finish();
+    void release();
+
+    bool loadWarmStates(const char *file);
+    bool saveWarmStates(const char *file);
+};
+
+#endif
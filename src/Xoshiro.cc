@@ -0,0 +1,81 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#include "Xoshiro.h"
+
+static inline uint64_t rotl(uint64_t x, int k) {
+
+    return (x << k) | (x >> (64 - k));
+}
+
+/**
+ * splitmix64: it spreads the seed over the whole state, as recommended by the authors.
+ */
+static uint64_t splitmix64(uint64_t& x) {
+
+    uint64_t z = (x += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+uint64_t streamSeed(int seed_set, int stream_id) {
+
+    uint64_t x = ((uint64_t) (uint32_t) seed_set << 32) | (uint32_t) stream_id;
+    return splitmix64(x);
+}
+
+Xoshiro256::Xoshiro256() {
+
+    seed(0, 0, false);
+}
+
+void Xoshiro256::seed(int seed_set, int stream_id, bool antithetic) {
+
+    uint64_t x = ((uint64_t) (uint32_t) seed_set << 32) | (uint32_t) stream_id;
+
+    for (int k = 0; k < 4; k++)
+        state[k] = splitmix64(x);
+
+    mask = antithetic ? ~(uint64_t) 0 : 0;
+
+    // The buffer is filled at the first draw.
+    next = XOSHIRO_BATCH;
+}
+
+void Xoshiro256::refill() {
+
+    uint64_t s0 = state[0], s1 = state[1], s2 = state[2], s3 = state[3];
+
+    for (int k = 0; k < XOSHIRO_BATCH; k++) {
+
+        buffer[k] = rotl(s1 * 5, 7) * 9;
+
+        uint64_t t = s1 << 17;
+        s2 ^= s0;
+        s3 ^= s1;
+        s1 ^= s2;
+        s0 ^= s3;
+        s2 ^= t;
+        s3 = rotl(s3, 45);
+    }
+
+    state[0] = s0;
+    state[1] = s1;
+    state[2] = s2;
+    state[3] = s3;
+
+    next = 0;
+}
@@ -0,0 +1,63 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#ifndef __SRAWN_XOSHIRO_H_
+#define __SRAWN_XOSHIRO_H_
+
+#include <stdint.h>
+
+// Number of 64-bit outputs generated at once.
+
+#define XOSHIRO_BATCH 64
+
+// 64-bit seed of a stream, hashed by splitmix64 from the seed-set and the stream identifier.
+uint64_t streamSeed(int seed_set, int stream_id);
+
+/**
+ * xoshiro256** generator (Blackman and Vigna): no virtual calls, and the outputs are
+ * generated in batches of XOSHIRO_BATCH into a buffer, so a draw is usually a load.
+ * With antithetic outputs every number X is replaced by its complement 2^64-1-X,
+ * i.e. a uniform number U by 1-U.
+ */
+class Xoshiro256
+{
+private:
+    uint64_t state[4];
+    uint64_t buffer[XOSHIRO_BATCH];
+    int next;
+    uint64_t mask;      //  0 or all ones (antithetic)
+
+    void refill();
+
+public:
+    Xoshiro256();
+
+    // The state depends only on the seed-set and on the stream identifier.
+    void seed(int seed_set, int stream_id, bool antithetic);
+
+    uint64_t next64() {
+        if (next == XOSHIRO_BATCH)
+            refill();
+        return buffer[next++] ^ mask;
+    }
+
+    // Uniform in [0,1), with 53 random bits.
+    double doubleRand() { return (next64() >> 11) * (1.0 / 9007199254740992.0); }
+
+    // Uniform integer in [0,n), by the multiply-shift of the upper 32 bits.
+    uint32_t intRand(uint32_t n) { return (uint32_t) (((next64() >> 32) * n) >> 32); }
+};
+
+#endif
@@ -0,0 +1,150 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+/*
+ * channeltrace: statistics of a per-slot channel activity trace written by the chosen one.
+ *
+ * Usage: channeltrace <trace file>
+ *
+ * It prints a CSV row for each channel: utilization (fraction of successful slots), fraction of
+ * collision slots, number, mean and maximum length of the collision bursts, mean and maximum gap
+ * (in slots) between two consecutive successes.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <vector>
+
+#include "ChannelTrace.h"
+
+// Statistics of one channel.
+
+struct ChannelStatistics {
+    uint64_t idle_slots;
+    uint64_t success_slots;
+    uint64_t collision_slots;
+
+    uint64_t bursts;                //  Number of collision bursts
+    uint64_t current_burst;         //  Length of the burst in progress
+    uint64_t max_burst;
+
+    uint64_t gaps;                  //  Number of gaps between two successes
+    uint64_t gap_sum;
+    uint64_t max_gap;
+    uint64_t last_success;          //  Slot of the last success + 1 ( 0: no success yet )
+
+    ChannelStatistics() : idle_slots(0), success_slots(0), collision_slots(0), bursts(0), current_burst(0),
+            max_burst(0), gaps(0), gap_sum(0), max_gap(0), last_success(0) {}
+};
+
+int main(int argc, char *argv[]) {
+
+    if (argc != 2) {
+        fprintf(stderr, "Usage: %s <channel trace>\n", argv[0]);
+        return 1;
+    }
+
+    ChannelTraceReader reader;
+
+    if (!reader.open(argv[1])) {
+        fprintf(stderr, "%s: cannot read the channel trace %s\n", argv[0], argv[1]);
+        return 1;
+    }
+
+    int channel_size = reader.getChannelSize();
+    std::vector<ChannelStatistics> statistics(channel_size);
+
+    const uint8_t *states;
+    uint64_t run;
+    uint64_t slot = 0;             //  First slot of the run
+
+    // Every run is processed as a whole: the cost does not depend on its length.
+    while ((run = reader.nextRun(states)) > 0) {
+
+        for (int j = 0; j < channel_size; j++) {
+
+            ChannelStatistics& s = statistics[j];
+            int state = ChannelTraceReader::state(states, j);
+
+            if (state == CHANNEL_COLLISION) {
+
+                if (s.current_burst == 0)
+                    s.bursts++;
+                s.current_burst += run;
+                s.collision_slots += run;
+
+                if (s.current_burst > s.max_burst)
+                    s.max_burst = s.current_burst;
+
+                continue;
+            }
+
+            s.current_burst = 0;
+
+            if (state == CHANNEL_IDLE) {
+                s.idle_slots += run;
+                continue;
+            }
+
+            // Successes: the first one closes the gap from the previous success, the others are consecutive.
+            if (s.last_success > 0) {
+
+                uint64_t gap = slot + 1 - s.last_success;
+                s.gaps++;
+                s.gap_sum += gap;
+                if (gap > s.max_gap)
+                    s.max_gap = gap;
+            }
+
+            if (run > 1) {
+                s.gaps += run - 1;
+                s.gap_sum += run - 1;
+                if (s.max_gap < 1)
+                    s.max_gap = 1;
+            }
+
+            s.success_slots += run;
+            s.last_success = slot + run;
+        }
+
+        slot += run;
+    }
+
+    if (reader.isCorrupted()) {
+        fprintf(stderr, "%s: the channel trace %s is corrupted after %llu slots\n", argv[0], argv[1],
+                (unsigned long long) slot);
+        return 1;
+    }
+
+    printf("channel,slots,utilization,collision_fraction,collision_bursts,mean_burst,max_burst,mean_success_gap,max_success_gap\n");
+
+    for (int j = 0; j < channel_size; j++) {
+
+        ChannelStatistics& s = statistics[j];
+        double slots = (slot > 0) ? (double) slot : 1;
+
+        printf("%d,%llu,%.6f,%.6f,%llu,%.3f,%llu,%.3f,%llu\n", j,
+                (unsigned long long) slot,
+                s.success_slots / slots,
+                s.collision_slots / slots,
+                (unsigned long long) s.bursts,
+                (s.bursts > 0) ? s.collision_slots / (double) s.bursts : 0.0,
+                (unsigned long long) s.max_burst,
+                (s.gaps > 0) ? s.gap_sum / (double) s.gaps : 0.0,
+                (unsigned long long) s.max_gap);
+    }
+
+    return 0;
+}
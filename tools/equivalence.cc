@@ -0,0 +1,551 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+/*
+ * equivalence: statistical comparison of the SRAWN results of a candidate engine with the ones of the reference model.
+ *
+ * Usage: equivalence [-a alpha] [-n samples] [-w warm-up] <reference .vec files> -- <candidate .vec files>
+ *
+ *   -a   family-wise significance level of all the tests together ( default: 0.05 )
+ *   -n   delay values kept for each side, by reservoir sampling ( default: 5000 )
+ *   -w   values recorded before this time are dropped ( default: 0 )
+ *
+ * Each vector file is one run, except that the vectors named "<signal>:lane<k>" ( the lanes of the ensemble
+ * engine ) make a run of their own for every k. The tests:
+ *   - throughput of each channel ( last value of channel_throughput<j> ), mean of
+ *     queue_dimension_per_slot_time and mean delay_time of each run: Welch's t-test on the run means.
+ *     The total throughput is the sum of the channel ones and is not tested again.
+ *   - delay_time distribution: two-sample Kolmogorov-Smirnov and Anderson-Darling ( Scholz and Stephens,
+ *     version for ties ) tests on the pooled delays. The delays of a run are correlated: the reservoir
+ *     keeps a sample spread over the whole run, which makes the tests closer to their nominal level.
+ *
+ * The p-values are adjusted by the Holm-Bonferroni method, so that the probability that any test of the run
+ * fails by chance is at most alpha.
+ *
+ * Output (CSV on stdout): metric, test, statistic, p-value, adjusted p-value, reference, candidate, verdict.
+ * The exit status is 0 if every test passes, 1 otherwise.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+// Options.
+
+static double alpha = 0.05;
+static size_t max_samples = 5000;
+static double warmup = 0;
+
+// Reservoir of the delays of one side: a uniform sample of everything it has seen.
+
+struct Reservoir {
+    std::vector<double> values;
+    uint64_t seen;
+    std::mt19937_64 rng;
+
+    Reservoir() : seen(0), rng(1) {}
+
+    void add(double value) {
+        seen++;
+        if (values.size() < max_samples)
+            values.push_back(value);
+        else {
+            uint64_t slot = std::uniform_int_distribution<uint64_t>(0, seen - 1)(rng);
+            if (slot < max_samples)
+                values[slot] = value;
+        }
+    }
+};
+
+// Results of one side: the means of every run for each metric, and the delays.
+
+struct Side {
+    std::map<std::string, std::vector<double> > run_values;
+    Reservoir delays;
+};
+
+// Sums of one run, while its file is read.
+
+struct Run {
+    std::map<std::string, double> last_value;               //  channel_throughput<j> -> last value
+    double queue_sum, delay_sum;
+    uint64_t queue_count, delay_count;
+
+    Run() : queue_sum(0), delay_sum(0), queue_count(0), delay_count(0) {}
+};
+
+static bool readRun(const char *path, Side& side) {
+
+    FILE *in = fopen(path, "r");
+    if (!in)
+        return false;
+
+    std::map<int, std::pair<std::string, std::string> > declarations;     //  Vector id -> signal, lane
+    std::map<std::string, Run> runs;                                        //  Lane ( "" if none ) -> run
+
+    char *line = 0;
+    size_t capacity = 0;
+
+    while (getline(&line, &capacity, in) > 0) {
+
+        if (line[0] >= '0' && line[0] <= '9') {
+
+            // Data line: "id [event] time value".
+            char *p;
+            int id = strtol(line, &p, 10);
+            double fields[3];
+            int n = 0;
+            while (n < 3 && *p != '\0' && *p != '\n')
+                fields[n++] = strtod(p, &p);
+            if (n < 2 || fields[n - 2] < warmup)
+                continue;
+
+            std::map<int, std::pair<std::string, std::string> >::iterator it = declarations.find(id);
+            if (it == declarations.end())
+                continue;
+
+            double value = fields[n - 1];
+            const std::string& signal = it->second.first;
+            Run& run = runs[it->second.second];
+
+            if (signal == "delay_time") {
+                run.delay_sum += value;
+                run.delay_count++;
+                side.delays.add(value);
+            }
+            else if (signal == "queue_dimension_per_slot_time") {
+                run.queue_sum += value;
+                run.queue_count++;
+            }
+            else
+                run.last_value[signal] = value;
+        }
+
+        else if (strncmp(line, "vector ", 7) == 0) {
+
+            // "vector id module name [columns]": the signal is the name up to the ':', a "lane<k>" after it is the lane.
+            char module[1024], name[1024];
+            int id;
+            if (sscanf(line, "vector %d %1023s %1023s", &id, module, name) == 3) {
+                std::string signal(name);
+                size_t colon = signal.find(':');
+                std::string lane;
+                if (colon != std::string::npos && signal.compare(colon + 1, 4, "lane") == 0)
+                    lane = signal.substr(colon + 1);
+                signal = signal.substr(0, colon);
+                if (signal == "delay_time" || signal == "queue_dimension_per_slot_time"
+                        || signal.compare(0, 18, "channel_throughput") == 0)
+                    declarations[id] = std::make_pair(signal, lane);
+            }
+        }
+    }
+
+    free(line);
+    fclose(in);
+
+    // A file without any of the vectors is still a run, and fails the comparison.
+    if (runs.empty())
+        runs[""];
+
+    for (std::map<std::string, Run>::iterator r = runs.begin(); r != runs.end(); ++r) {
+
+        Run& run = r->second;
+
+        for (std::map<std::string, double>::iterator it = run.last_value.begin(); it != run.last_value.end(); ++it)
+            side.run_values[it->first].push_back(it->second);
+
+        side.run_values["queue_length_mean"].push_back(run.queue_count > 0 ? run.queue_sum / run.queue_count : 0);
+        side.run_values["delay_mean"].push_back(run.delay_count > 0 ? run.delay_sum / run.delay_count : 0);
+    }
+
+    return true;
+}
+
+/* TESTS */
+
+// Critical values of the standardized Anderson-Darling statistic ( k = 2 ) at the tabulated levels.
+
+static const double levels[] = { 0.25, 0.10, 0.05, 0.025, 0.01 };
+static const double ad_critical[] = { 0.326, 1.225, 1.960, 2.719, 3.752 };
+
+// Continued fraction of the incomplete beta function ( modified Lentz's method ).
+static double betaFraction(double a, double b, double x) {
+    double c = 1, d = 1 - (a + b) * x / (a + 1);
+    d = 1 / (fabs(d) < 1e-300 ? 1e-300 : d);
+    double h = d;
+    for (int m = 1; m <= 300; m++) {
+        for (int step = 0; step < 2; step++) {
+            double aa = step == 0 ? m * (b - m) * x / ((a + 2 * m - 1) * (a + 2 * m))
+                    : -(a + m) * (a + b + m) * x / ((a + 2 * m) * (a + 2 * m + 1));
+            d = 1 + aa * d;
+            d = 1 / (fabs(d) < 1e-300 ? 1e-300 : d);
+            c = 1 + aa / c;
+            if (fabs(c) < 1e-300)
+                c = 1e-300;
+            h *= d * c;
+            if (step == 1 && fabs(d * c - 1) < 1e-14)
+                return h;
+        }
+    }
+    return h;
+}
+
+// Regularized incomplete beta function I_x(a, b).
+static double incompleteBeta(double a, double b, double x) {
+    if (x <= 0)
+        return 0;
+    if (x >= 1)
+        return 1;
+    double front = exp(lgamma(a + b) - lgamma(a) - lgamma(b) + a * log(x) + b * log(1 - x));
+    if (x < (a + 1) / (a + b + 2))
+        return front * betaFraction(a, b, x) / a;
+    return 1 - front * betaFraction(b, a, 1 - x) / b;
+}
+
+// Two-sided p-value of Student's t distribution: P(|T| > t).
+static double tPValue(double t, double df) {
+    return incompleteBeta(df / 2, 0.5, df / (df + t * t));
+}
+
+/**
+ * p-value of the standardized Anderson-Darling statistic: log p is fitted by least squares with a quadratic
+ * in T through the tabulated critical values ( as scipy does ). Past the last one the quadratic would turn
+ * up again, so it is continued along its tangent.
+ */
+static double adPValue(double T) {
+
+    static double coefficients[3];
+    static bool fitted = false;
+
+    if (!fitted) {
+
+        // Normal equations of the fit, solved by Gauss-Jordan elimination.
+        double A[3][4] = { { 0 } };
+        for (int l = 0; l < 5; l++) {
+            double powers[3] = { 1, ad_critical[l], ad_critical[l] * ad_critical[l] };
+            for (int i = 0; i < 3; i++) {
+                for (int j = 0; j < 3; j++)
+                    A[i][j] += powers[i] * powers[j];
+                A[i][3] += powers[i] * log(levels[l]);
+            }
+        }
+        for (int i = 0; i < 3; i++)
+            for (int j = 0; j < 3; j++)
+                if (j != i) {
+                    double factor = A[j][i] / A[i][i];
+                    for (int k = 0; k < 4; k++)
+                        A[j][k] -= factor * A[i][k];
+                }
+        for (int i = 0; i < 3; i++)
+            coefficients[i] = A[i][3] / A[i][i];
+        fitted = true;
+    }
+
+    double last = ad_critical[4];
+    double log_p;
+    if (T <= last)
+        log_p = coefficients[0] + coefficients[1] * T + coefficients[2] * T * T;
+    else
+        log_p = coefficients[0] + coefficients[1] * last + coefficients[2] * last * last
+                + (coefficients[1] + 2 * coefficients[2] * last) * (T - last);
+
+    return std::min(1.0, exp(log_p));
+}
+
+static void meanAndVariance(const std::vector<double>& x, double& mean, double& variance) {
+    mean = 0;
+    for (size_t i = 0; i < x.size(); i++)
+        mean += x[i] / x.size();
+    variance = 0;
+    for (size_t i = 0; i < x.size(); i++)
+        variance += (x[i] - mean) * (x[i] - mean);
+    variance = (x.size() > 1) ? variance / (x.size() - 1) : 0;
+}
+
+// Outcome of one test, reported once all of them are known.
+
+struct Test {
+    std::string metric;
+    const char *test;
+    double statistic;
+    double p_value;
+    double reference;
+    double candidate;
+};
+
+static std::vector<Test> tests;
+
+static void report(const std::string& metric, const char *test, double statistic, double p_value,
+        double reference, double candidate) {
+
+    Test result = { metric, test, statistic, p_value, reference, candidate };
+    tests.push_back(result);
+}
+
+/**
+ * Holm-Bonferroni: the i-th smallest of m p-values is multiplied by m - i ( i from 0 ), and the adjusted
+ * values are made non-decreasing. A test fails when its adjusted p-value is at most alpha. It returns the
+ * number of failures.
+ */
+static int printTests() {
+
+    size_t m = tests.size();
+    std::vector<size_t> order(m);
+    for (size_t i = 0; i < m; i++)
+        order[i] = i;
+    std::stable_sort(order.begin(), order.end(),
+            [](size_t a, size_t b) { return tests[a].p_value < tests[b].p_value; });
+
+    std::vector<double> adjusted(m);
+    double running = 0;
+    for (size_t i = 0; i < m; i++) {
+        running = std::max(running, std::min(1.0, (m - i) * tests[order[i]].p_value));
+        adjusted[order[i]] = running;
+    }
+
+    int failures = 0;
+    printf("metric,test,statistic,p_value,adjusted_p_value,reference,candidate,verdict\n");
+
+    for (size_t i = 0; i < m; i++) {
+        const Test& t = tests[i];
+        bool pass = adjusted[i] > alpha;
+        printf("%s,%s,%.6g,%.6g,%.6g,%.9g,%.9g,%s\n", t.metric.c_str(), t.test, t.statistic, t.p_value, adjusted[i],
+                t.reference, t.candidate, pass ? "pass" : "FAIL");
+        if (!pass)
+            failures++;
+    }
+
+    return failures;
+}
+
+/**
+ * Welch's t-test on the run means: the statistic is |difference| / standard error.
+ */
+static void welchTest(const std::string& metric, const std::vector<double>& x, const std::vector<double>& y) {
+
+    double mx, vx, my, vy;
+    meanAndVariance(x, mx, vx);
+    meanAndVariance(y, my, vy);
+
+    double sx = vx / x.size(), sy = vy / y.size();
+    double error = sqrt(sx + sy);
+
+    // Both sides without variance ( e.g. one run each ): they must agree exactly.
+    if (error == 0) {
+        report(metric, "welch", fabs(mx - my), mx == my ? 1 : 0, mx, my);
+        return;
+    }
+
+    double df = (sx + sy) * (sx + sy) / ((x.size() > 1 ? sx * sx / (x.size() - 1) : 0)
+            + (y.size() > 1 ? sy * sy / (y.size() - 1) : 0));
+    double t = fabs(mx - my) / error;
+
+    report(metric, "welch", t, tPValue(t, df), mx, my);
+}
+
+// Kolmogorov's distribution: P(K > lambda).
+static double kolmogorovQ(double lambda) {
+    if (lambda < 0.2)
+        return 1;
+    double sum = 0;
+    for (int j = 1; j <= 100; j++) {
+        double term = 2 * ((j % 2) ? 1 : -1) * exp(-2 * j * j * lambda * lambda);
+        sum += term;
+        if (fabs(term) < 1e-12)
+            break;
+    }
+    return std::min(1.0, std::max(0.0, sum));
+}
+
+/**
+ * Two-sample Kolmogorov-Smirnov test: largest distance between the two empirical distributions,
+ * asymptotic p-value with the correction of Stephens.
+ */
+static void ksTest(const std::vector<double>& x, const std::vector<double>& y) {
+
+    size_t i = 0, j = 0;
+    double d = 0;
+
+    while (i < x.size() && j < y.size()) {
+        double v = std::min(x[i], y[j]);
+        while (i < x.size() && x[i] == v) i++;
+        while (j < y.size() && y[j] == v) j++;
+        d = std::max(d, fabs((double) i / x.size() - (double) j / y.size()));
+    }
+
+    double ne = (double) x.size() * y.size() / (x.size() + y.size());
+    double p = kolmogorovQ((sqrt(ne) + 0.12 + 0.11 / sqrt(ne)) * d);
+
+    report("delay_time", "kolmogorov_smirnov", d, p, x.size(), y.size());
+}
+
+/**
+ * k-sample Anderson-Darling test for k = 2 ( Scholz and Stephens 1987, A2akN for ties ), standardized:
+ * T = ( A2 - ( k - 1 ) ) / sigma.
+ */
+static void andersonDarlingTest(const std::vector<double>& x, const std::vector<double>& y) {
+
+    const std::vector<double>* samples[2] = { &x, &y };
+    double n[2] = { (double) x.size(), (double) y.size() };
+    double N = n[0] + n[1];
+    int k = 2;
+
+    // Walk the distinct values of the pooled sample.
+    size_t position[2] = { 0, 0 };
+    double M[2] = { 0, 0 };         //  Values of each sample up to the current one, included
+    double B = 0;                   //  Values of the pooled sample up to the current one, included
+    double sums[2] = { 0, 0 };
+
+    while (position[0] < x.size() || position[1] < y.size()) {
+
+        double v = INFINITY;
+        for (int s = 0; s < k; s++)
+            if (position[s] < samples[s]->size())
+                v = std::min(v, (*samples[s])[position[s]]);
+
+        double f[2] = { 0, 0 };
+        for (int s = 0; s < k; s++)
+            while (position[s] < samples[s]->size() && (*samples[s])[position[s]] == v) {
+                position[s]++;
+                f[s]++;
+            }
+
+        double l = f[0] + f[1];
+        B += l;
+        double Ba = B - l / 2;
+        double denominator = Ba * (N - Ba) - N * l / 4;
+
+        for (int s = 0; s < k; s++) {
+            M[s] += f[s];
+            double Ma = M[s] - f[s] / 2;
+            if (denominator > 0)
+                sums[s] += l / N * (N * Ma - n[s] * Ba) * (N * Ma - n[s] * Ba) / denominator;
+        }
+    }
+
+    double A2 = (N - 1) / N * (sums[0] / n[0] + sums[1] / n[1]);
+
+    // Variance of A2 under the null hypothesis.
+    double H = 1 / n[0] + 1 / n[1];
+    std::vector<double> harmonic((size_t) N, 0);        //  harmonic[i] = 1 + 1/2 + ... + 1/i
+    for (int i = 1; i < N; i++)
+        harmonic[i] = harmonic[i - 1] + 1.0 / i;
+    double h = harmonic[N - 1];
+    double g = 0;
+    for (int i = 1; i <= N - 2; i++)
+        g += (harmonic[N - 1] - harmonic[i]) / (N - i);
+
+    double a = (4 * g - 6) * (k - 1) + (10 - 6 * g) * H;
+    double b = (2 * g - 4) * k * k + 8 * h * k + (2 * g - 14 * h - 4) * H - 8 * h + 4 * g - 6;
+    double c = (6 * h + 2 * g - 2) * k * k + (4 * h - 4 * g + 6) * k + (2 * h - 6) * H + 4 * h;
+    double d = (2 * h + 6) * k * k - 4 * h * k;
+    double variance = (a * N * N * N + b * N * N + c * N + d) / ((N - 1) * (N - 2) * (N - 3));
+
+    double T = (A2 - (k - 1)) / sqrt(variance);
+
+    report("delay_time", "anderson_darling", T, adPValue(T), x.size(), y.size());
+}
+
+static void usage(const char *program) {
+    fprintf(stderr, "Usage: %s [-a alpha] [-n samples] [-w warm-up] <reference .vec files> -- <candidate .vec files>\n",
+            program);
+}
+
+int main(int argc, char *argv[]) {
+
+    int opt;
+
+    while ((opt = getopt(argc, argv, "+a:n:w:")) != -1) {
+        switch (opt) {
+            case 'a': alpha = atof(optarg); break;
+            case 'n': max_samples = atol(optarg); break;
+            case 'w': warmup = atof(optarg); break;
+            default:
+                usage(argv[0]);
+                return 2;
+        }
+    }
+
+    if (!(alpha > 0 && alpha < 1) || max_samples < 10) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    // getopt ( "+": no permutation ) stops at the first file: the reference files come before "--".
+    int separator = -1;
+    for (int a = optind; a < argc; a++)
+        if (strcmp(argv[a], "--") == 0)
+            separator = a;
+
+    if (optind > 0 && strcmp(argv[optind - 1], "--") == 0) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    if (separator <= optind || separator == argc - 1) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    Side sides[2];
+
+    for (int a = optind; a < argc; a++) {
+
+        if (a == separator)
+            continue;
+
+        if (!readRun(argv[a], sides[a > separator ? 1 : 0])) {
+            fprintf(stderr, "%s: cannot read %s\n", argv[0], argv[a]);
+            return 2;
+        }
+    }
+
+    // Run means: every metric of the reference must be in the candidate too.
+    std::map<std::string, std::vector<double> >::iterator it;
+    for (it = sides[0].run_values.begin(); it != sides[0].run_values.end(); ++it) {
+
+        if (!sides[1].run_values.count(it->first)) {
+            report(it->first, "missing", 0, 0, 0, 0);
+            continue;
+        }
+
+        welchTest(it->first, it->second, sides[1].run_values[it->first]);
+    }
+
+    // Distribution of the delays.
+    std::vector<double>& x = sides[0].delays.values;
+    std::vector<double>& y = sides[1].delays.values;
+
+    if (x.size() >= 10 && y.size() >= 10) {
+
+        std::sort(x.begin(), x.end());
+        std::sort(y.begin(), y.end());
+
+        ksTest(x, y);
+        andersonDarlingTest(x, y);
+    }
+    else
+        report("delay_time", "too_few_delays", 0, 0, x.size(), y.size());
+
+    return printTests() > 0 ? 1 : 0;
+}
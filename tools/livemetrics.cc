@@ -0,0 +1,118 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+/*
+ * livemetrics: it follows the live metrics published by a running simulation.
+ *
+ * Usage: livemetrics <segment name> [ period in seconds ]     ( e.g. livemetrics /srawn-12345 1 )
+ *        livemetrics -r <segment name>
+ *
+ * It prints a CSV row at every period until the simulation is over.
+ * With -r it removes a segment left by a run with live_metrics_keep = true.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "LiveMetrics.h"
+
+// Consistent copy of the snapshot: retry while the writer is updating it.
+
+static void readSnapshot(const LiveMetricsSnapshot *shared, LiveMetricsSnapshot& copy) {
+
+    for (;;) {
+
+        uint64_t before = shared->sequence;
+        __sync_synchronize();
+        memcpy(&copy, (const void*) shared, sizeof(copy));
+        __sync_synchronize();
+
+        if ((before & 1) == 0 && before == shared->sequence)
+            return;
+
+        usleep(100);
+    }
+}
+
+int main(int argc, char *argv[]) {
+
+    if (argc < 2 || (strcmp(argv[1], "-r") == 0 && argc != 3)) {
+        fprintf(stderr, "Usage: %s <segment name> [period in seconds]\n       %s -r <segment name>\n", argv[0], argv[0]);
+        return 1;
+    }
+
+    if (strcmp(argv[1], "-r") == 0) {
+
+        if (shm_unlink(argv[2]) != 0) {
+            fprintf(stderr, "%s: cannot remove the live metrics segment %s\n", argv[0], argv[2]);
+            return 1;
+        }
+
+        return 0;
+    }
+
+    double period = (argc > 2) ? atof(argv[2]) : 1;
+
+    int fd = shm_open(argv[1], O_RDONLY, 0);
+    if (fd < 0) {
+        fprintf(stderr, "%s: cannot open the live metrics segment %s\n", argv[0], argv[1]);
+        return 1;
+    }
+
+    void *map = mmap(0, sizeof(LiveMetricsSnapshot), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "%s: cannot map the live metrics segment %s\n", argv[0], argv[1]);
+        return 1;
+    }
+
+    const LiveMetricsSnapshot *shared = (const LiveMetricsSnapshot*) map;
+    LiveMetricsSnapshot snapshot;
+
+    if (shared->magic != LIVE_METRICS_MAGIC || shared->version != LIVE_METRICS_VERSION) {
+        fprintf(stderr, "%s: %s is not a live metrics segment\n", argv[0], argv[1]);
+        return 1;
+    }
+
+    printf("pid,wall_time,sim_time,slot,events,events_per_sec,throughput,mean_queue_length,delivered,delay_p50,delay_p90,delay_p99\n");
+
+    do {
+
+        readSnapshot(shared, snapshot);
+
+        printf("%d,%.3f,%.6f,%llu,%llu,%.1f,%.6f,%.3f,%llu,%.6f,%.6f,%.6f\n",
+                snapshot.pid, snapshot.wall_time, snapshot.sim_time,
+                (unsigned long long) snapshot.slot_counter, (unsigned long long) snapshot.events,
+                snapshot.events_per_second, snapshot.throughput, snapshot.mean_queue_length,
+                (unsigned long long) snapshot.delivered_packets,
+                snapshot.delay_p50, snapshot.delay_p90, snapshot.delay_p99);
+        fflush(stdout);
+
+        if (snapshot.finished)
+            break;
+
+        usleep((useconds_t) (period * 1e6));
+
+    } while (true);
+
+    munmap(map, sizeof(LiveMetricsSnapshot));
+
+    return 0;
+}
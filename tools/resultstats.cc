@@ -0,0 +1,546 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+/*
+ * resultstats: statistics of the SRAWN signals from OMNeT++ result files, in one streaming pass.
+ *
+ * Usage: resultstats [-w warm-up seconds] [-b batches] [-a] [-j threads] <file.vec | file.sca> ...
+ *
+ *   -w   values recorded before this time are dropped ( default: 0, OMNeT++ already drops
+ *        the values of the warm-up period when it records them )
+ *   -b   number of batches for the batch means confidence interval of each run ( default: 20 )
+ *   -a   all the vectors, not only channel_throughput*, queue_dimension_per_slot_time and delay_time
+ *   -j   worker threads ( default: number of CPUs )
+ *
+ * Every file is memory-mapped and split into chunks on line boundaries; the chunks are parsed in parallel.
+ * Each vector file is one run. Values of the same signal recorded by different modules
+ * (e.g. the queue dimension of every transmitter) are merged.
+ *
+ * Output (CSV on stdout):
+ *   scope = "run": one row per run and signal, the CI comes from the batch means.
+ *   scope = "all": one row per signal over all the runs, the CI comes from the means of the runs.
+ *   scope = "scalar": scalars of the .sca files, one row per module and name over all the runs.
+ * Quantiles come from a log-linear histogram (relative error below 1%).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Log-linear histogram: 2^7 sub-bins for each power of two; zero and negative values have their own bins.
+
+#define SUB_BINS 128
+#define MIN_EXPONENT (-40)
+#define MAX_EXPONENT 40
+#define HISTOGRAM_BINS ((MAX_EXPONENT - MIN_EXPONENT) * SUB_BINS + 2)
+
+struct Histogram {
+    std::vector<uint64_t> bins;
+
+    void add(double value) {
+        if (bins.empty())
+            bins.assign(HISTOGRAM_BINS, 0);
+        bins[binOf(value)]++;
+    }
+
+    void merge(const Histogram& other) {
+        if (other.bins.empty())
+            return;
+        if (bins.empty())
+            bins.assign(HISTOGRAM_BINS, 0);
+        for (size_t i = 0; i < bins.size(); i++)
+            bins[i] += other.bins[i];
+    }
+
+    static int binOf(double value) {
+        if (value <= 0)
+            return 0;
+        int exponent;
+        double mantissa = frexp(value, &exponent);     //  value = mantissa * 2^exponent, mantissa in [0.5,1)
+        if (exponent < MIN_EXPONENT)
+            return 1;
+        if (exponent >= MAX_EXPONENT)
+            return HISTOGRAM_BINS - 1;
+        return 1 + (exponent - MIN_EXPONENT) * SUB_BINS + (int) ((mantissa - 0.5) * 2 * SUB_BINS);
+    }
+
+    // Middle point of a bin.
+    static double valueOf(int bin) {
+        if (bin == 0)
+            return 0;
+        int exponent = (bin - 1) / SUB_BINS + MIN_EXPONENT;
+        int sub = (bin - 1) % SUB_BINS;
+        return ldexp(0.5 + (sub + 0.5) / (2 * SUB_BINS), exponent);
+    }
+
+    double quantile(double q, uint64_t count) const {
+        if (bins.empty() || count == 0)
+            return 0;
+        uint64_t rank = (uint64_t) ceil(q * count);
+        if (rank == 0)
+            rank = 1;
+        uint64_t cumulative = 0;
+        for (size_t i = 0; i < bins.size(); i++) {
+            cumulative += bins[i];
+            if (cumulative >= rank)
+                return valueOf(i);
+        }
+        return valueOf(bins.size() - 1);
+    }
+};
+
+// Accumulator of one signal: moments, batches and histogram.
+
+struct Accumulator {
+    uint64_t count;
+    double sum;
+    double squares;
+    double min;
+    double max;
+    std::vector<double> batch_sum;
+    std::vector<uint64_t> batch_count;
+    Histogram histogram;
+
+    Accumulator() : count(0), sum(0), squares(0), min(INFINITY), max(-INFINITY) {}
+
+    void add(double value, int batch) {
+        count++;
+        sum += value;
+        squares += value * value;
+        if (value < min) min = value;
+        if (value > max) max = value;
+        if (batch >= 0) {
+            if ((size_t) batch >= batch_sum.size()) {
+                batch_sum.resize(batch + 1, 0);
+                batch_count.resize(batch + 1, 0);
+            }
+            batch_sum[batch] += value;
+            batch_count[batch]++;
+        }
+        histogram.add(value);
+    }
+
+    void merge(const Accumulator& other) {
+        count += other.count;
+        sum += other.sum;
+        squares += other.squares;
+        min = std::min(min, other.min);
+        max = std::max(max, other.max);
+        if (other.batch_sum.size() > batch_sum.size()) {
+            batch_sum.resize(other.batch_sum.size(), 0);
+            batch_count.resize(other.batch_count.size(), 0);
+        }
+        for (size_t b = 0; b < other.batch_sum.size(); b++) {
+            batch_sum[b] += other.batch_sum[b];
+            batch_count[b] += other.batch_count[b];
+        }
+        histogram.merge(other.histogram);
+    }
+
+    double mean() const { return count > 0 ? sum / count : 0; }
+
+    double stddev() const {
+        if (count < 2)
+            return 0;
+        double variance = (squares - count * mean() * mean()) / (count - 1);
+        return variance > 0 ? sqrt(variance) : 0;
+    }
+};
+
+// Options.
+
+static double warmup = 0;
+static int batches = 20;
+static bool all_vectors = false;
+
+// Student's t quantile for a 95% confidence interval.
+
+static double t95(int df) {
+    static const double t[] = { 12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+            2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+            2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042 };
+    if (df < 1)
+        return 0;
+    return (df <= 30) ? t[df - 1] : 1.960;
+}
+
+static double confidenceInterval(const std::vector<double>& means) {
+    int n = means.size();
+    if (n < 2)
+        return 0;
+    double sum = 0, squares = 0;
+    for (int i = 0; i < n; i++) {
+        sum += means[i];
+        squares += means[i] * means[i];
+    }
+    double mean = sum / n;
+    double variance = (squares - n * mean * mean) / (n - 1);
+    return t95(n - 1) * sqrt(variance > 0 ? variance : 0) / sqrt(n);
+}
+
+// The signal of a vector name: "channel_throughput3:vector" -> "channel_throughput3".
+
+static bool signalOf(const std::string& vector_name, std::string& signal) {
+    signal = vector_name.substr(0, vector_name.find(':'));
+    if (all_vectors)
+        return true;
+    return signal.compare(0, 18, "channel_throughput") == 0
+            || signal.compare(0, 29, "queue_dimension_per_slot_time") == 0
+            || signal.compare(0, 10, "delay_time") == 0;
+}
+
+/* MAPPED FILES AND CHUNKS */
+
+struct ResultFile {
+    std::string path;
+    const char *data;
+    size_t length;
+    bool is_vector;
+    std::string run;
+    double end_time;                //  Time of the last vector value
+
+    // Scalar files: "module name" -> value.
+    std::vector< std::pair<std::string, double> > scalars;
+};
+
+struct Chunk {
+    ResultFile *file;
+    size_t begin;
+    size_t end;
+
+    std::map<int, std::string> declarations;    //  Vector id -> vector name
+    std::map<int, Accumulator> accumulators;    //  Vector id -> values
+};
+
+static const char *nextLine(const char *p, const char *end) {
+    const char *newline = (const char*) memchr(p, '\n', end - p);
+    return newline ? newline + 1 : end;
+}
+
+static void parseLine(Chunk& chunk, const char *line, const char *end) {
+
+    ResultFile& file = *chunk.file;
+
+    if (line[0] >= '0' && line[0] <= '9') {
+
+        // Data line: "id [event] time value", separated by tabs.
+        char *p;
+        int id = strtol(line, &p, 10);
+        double fields[3];
+        int n = 0;
+        while (n < 3 && p < end && *p != '\n') {
+            fields[n++] = strtod(p, &p);
+        }
+        if (n < 2)
+            return;
+        double time = fields[n - 2];
+        double value = fields[n - 1];
+
+        if (time < warmup)
+            return;
+
+        int batch = -1;
+        if (file.end_time > warmup)
+            batch = std::min(batches - 1, (int) ((time - warmup) / (file.end_time - warmup) * batches));
+
+        chunk.accumulators[id].add(value, batch);
+        return;
+    }
+
+    std::string text(line, end - line);
+    if (!text.empty() && text[text.size() - 1] == '\n')
+        text.erase(text.size() - 1);
+
+    if (text.compare(0, 7, "vector ") == 0) {
+
+        // "vector id module name [columns]"
+        char module[1024], name[1024];
+        int id;
+        if (sscanf(text.c_str(), "vector %d %1023s %1023s", &id, module, name) == 3)
+            chunk.declarations[id] = name;
+    }
+
+    else if (text.compare(0, 7, "scalar ") == 0) {
+
+        // "scalar module name value"
+        char module[1024], name[1024];
+        double value;
+        if (sscanf(text.c_str(), "scalar %1023s %1023s %lf", module, name, &value) == 3)
+            file.scalars.push_back(std::make_pair(std::string(module) + " " + name, value));
+    }
+}
+
+static void parseChunk(Chunk& chunk) {
+
+    const char *p = chunk.file->data + chunk.begin;
+    const char *end = chunk.file->data + chunk.end;
+
+    while (p < end) {
+        const char *next = nextLine(p, end);
+        parseLine(chunk, p, next);
+        p = next;
+    }
+}
+
+static bool mapFile(ResultFile& file) {
+
+    int fd = open(file.path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        return false;
+    }
+
+    file.length = info.st_size;
+    file.data = 0;
+
+    if (file.length > 0) {
+        void *map = mmap(0, file.length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map == MAP_FAILED) {
+            close(fd);
+            return false;
+        }
+        madvise(map, file.length, MADV_SEQUENTIAL);
+        file.data = (const char*) map;
+    }
+
+    close(fd);
+
+    // Run name: the "run" line of the header.
+    const char *end = file.data + file.length;
+    for (const char *p = file.data; p < end && p < file.data + 65536; p = nextLine(p, end)) {
+        if (strncmp(p, "run ", 4) == 0) {
+            const char *stop = nextLine(p, end);
+            file.run = std::string(p + 4, stop - p - 4);
+            while (!file.run.empty() && (file.run[file.run.size() - 1] == '\n' || file.run[file.run.size() - 1] == '\r'))
+                file.run.erase(file.run.size() - 1);
+            break;
+        }
+    }
+    if (file.run.empty())
+        file.run = file.path;
+
+    // End time: the time of the last data line, needed to place the batches.
+    file.end_time = 0;
+    const char *p = end;
+    while (p > file.data) {
+        const char *line = p - 1;
+        while (line > file.data && line[-1] != '\n')
+            line--;
+        if (*line >= '0' && *line <= '9') {
+            char *q;
+            strtol(line, &q, 10);
+            double fields[3];
+            int n = 0;
+            while (n < 3 && q < p && *q != '\n')
+                fields[n++] = strtod(q, &q);
+            if (n >= 2)
+                file.end_time = fields[n - 2];
+            break;
+        }
+        p = line;
+    }
+
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+
+    int threads = std::thread::hardware_concurrency();
+    int opt;
+
+    while ((opt = getopt(argc, argv, "w:b:aj:")) != -1) {
+        switch (opt) {
+            case 'w': warmup = atof(optarg); break;
+            case 'b': batches = atoi(optarg); break;
+            case 'a': all_vectors = true; break;
+            case 'j': threads = atoi(optarg); break;
+            default:
+                fprintf(stderr, "Usage: %s [-w warm-up] [-b batches] [-a] [-j threads] <file.vec | file.sca> ...\n", argv[0]);
+                return 1;
+        }
+    }
+
+    if (optind >= argc || batches < 1) {
+        fprintf(stderr, "Usage: %s [-w warm-up] [-b batches] [-a] [-j threads] <file.vec | file.sca> ...\n", argv[0]);
+        return 1;
+    }
+
+    if (threads < 1)
+        threads = 1;
+
+    std::vector<ResultFile> files(argc - optind);
+    std::vector<Chunk> chunks;
+
+    // Chunks of about 64 MiB, split on line boundaries; scalar files are a single chunk.
+    const size_t chunk_size = 64 << 20;
+
+    for (size_t f = 0; f < files.size(); f++) {
+
+        ResultFile& file = files[f];
+        file.path = argv[optind + f];
+        file.is_vector = file.path.size() > 4 && file.path.compare(file.path.size() - 4, 4, ".vec") == 0;
+
+        if (!mapFile(file)) {
+            fprintf(stderr, "%s: cannot read %s\n", argv[0], file.path.c_str());
+            return 1;
+        }
+
+        size_t begin = 0;
+        while (begin < file.length) {
+            size_t end = file.is_vector ? std::min(file.length, begin + chunk_size) : file.length;
+            if (end < file.length)
+                end = nextLine(file.data + end, file.data + file.length) - file.data;
+            Chunk chunk;
+            chunk.file = &file;
+            chunk.begin = begin;
+            chunk.end = end;
+            chunks.push_back(chunk);
+            begin = end;
+        }
+    }
+
+    // Scalar files keep their scalars in the ResultFile: they must not be shared by two chunks.
+    std::atomic<size_t> next_chunk(0);
+    std::vector<std::thread> workers;
+
+    for (int t = 0; t < threads; t++)
+        workers.push_back(std::thread([&]() {
+            size_t c;
+            while ((c = next_chunk++) < chunks.size())
+                parseChunk(chunks[c]);
+        }));
+
+    for (size_t t = 0; t < workers.size(); t++)
+        workers[t].join();
+
+    // Merge the chunks of each run: vector ids are resolved to signals only now,
+    // because a chunk can hold values of a vector declared in a previous chunk.
+    std::map<std::string, std::map<std::string, Accumulator> > runs;     //  run -> signal -> values
+    std::map<std::string, std::vector<double> > scalars;                 //  "module name" -> values
+
+    for (size_t f = 0; f < files.size(); f++) {
+
+        ResultFile& file = files[f];
+        std::map<int, std::string> declarations;
+
+        for (size_t c = 0; c < chunks.size(); c++)
+            if (chunks[c].file == &file)
+                declarations.insert(chunks[c].declarations.begin(), chunks[c].declarations.end());
+
+        for (size_t c = 0; c < chunks.size(); c++) {
+
+            if (chunks[c].file != &file)
+                continue;
+
+            std::map<int, Accumulator>::iterator it;
+            for (it = chunks[c].accumulators.begin(); it != chunks[c].accumulators.end(); ++it) {
+                std::string signal;
+                if (declarations.count(it->first) && signalOf(declarations[it->first], signal))
+                    runs[file.run][signal].merge(it->second);
+            }
+        }
+
+        for (size_t s = 0; s < file.scalars.size(); s++)
+            scalars[file.scalars[s].first].push_back(file.scalars[s].second);
+
+        if (file.data != 0)
+            munmap((void*) file.data, file.length);
+    }
+
+    printf("scope,run,signal,count,mean,stddev,ci95,min,max,p50,p90,p99\n");
+
+    std::map<std::string, Accumulator> pooled;
+    std::map<std::string, std::vector<double> > run_means;
+
+    std::map<std::string, std::map<std::string, Accumulator> >::iterator run;
+    for (run = runs.begin(); run != runs.end(); ++run) {
+
+        std::map<std::string, Accumulator>::iterator it;
+        for (it = run->second.begin(); it != run->second.end(); ++it) {
+
+            const Accumulator& a = it->second;
+
+            // Batch means: the CI of the run.
+            std::vector<double> means;
+            for (size_t b = 0; b < a.batch_sum.size(); b++)
+                if (a.batch_count[b] > 0)
+                    means.push_back(a.batch_sum[b] / a.batch_count[b]);
+
+            printf("run,\"%s\",%s,%llu,%.9g,%.9g,%.9g,%.9g,%.9g,%.9g,%.9g,%.9g\n",
+                    run->first.c_str(), it->first.c_str(), (unsigned long long) a.count,
+                    a.mean(), a.stddev(), confidenceInterval(means), a.min, a.max,
+                    a.histogram.quantile(0.50, a.count), a.histogram.quantile(0.90, a.count),
+                    a.histogram.quantile(0.99, a.count));
+
+            pooled[it->first].merge(a);
+            run_means[it->first].push_back(a.mean());
+        }
+    }
+
+    std::map<std::string, Accumulator>::iterator it;
+    for (it = pooled.begin(); it != pooled.end(); ++it) {
+
+        const Accumulator& a = it->second;
+        const std::vector<double>& means = run_means[it->first];
+        double mean = 0;
+        for (size_t r = 0; r < means.size(); r++)
+            mean += means[r] / means.size();
+
+        printf("all,%zu,%s,%llu,%.9g,%.9g,%.9g,%.9g,%.9g,%.9g,%.9g,%.9g\n",
+                means.size(), it->first.c_str(), (unsigned long long) a.count,
+                mean, a.stddev(), confidenceInterval(means), a.min, a.max,
+                a.histogram.quantile(0.50, a.count), a.histogram.quantile(0.90, a.count),
+                a.histogram.quantile(0.99, a.count));
+    }
+
+    std::map<std::string, std::vector<double> >::iterator scalar;
+    for (scalar = scalars.begin(); scalar != scalars.end(); ++scalar) {
+
+        const std::vector<double>& values = scalar->second;
+        double sum = 0, squares = 0;
+        double min = INFINITY, max = -INFINITY;
+        for (size_t r = 0; r < values.size(); r++) {
+            sum += values[r];
+            squares += values[r] * values[r];
+            min = std::min(min, values[r]);
+            max = std::max(max, values[r]);
+        }
+        double n = values.size();
+        double mean = sum / n;
+        double variance = (n > 1) ? (squares - n * mean * mean) / (n - 1) : 0;
+
+        printf("scalar,%zu,\"%s\",%zu,%.9g,%.9g,%.9g,%.9g,%.9g,,,\n",
+                values.size(), scalar->first.c_str(), values.size(), mean,
+                sqrt(variance > 0 ? variance : 0), confidenceInterval(values), min, max);
+    }
+
+    return 0;
+}
@@ -0,0 +1,210 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+/*
+ * vecconvert: conversion of a compressed columnar vector file ( .vecc ) into a standard OMNeT++ .vec file.
+ *
+ * Usage: vecconvert [-l] [-m module] [-n name] [-s start] [-e end] [-p precision] <.vecc file> [.vec file]
+ *
+ *   -l   list the vectors with their records and time range ( from the index ), without converting
+ *   -m   only the vectors whose module path contains this string
+ *   -n   only the vectors whose name contains this string
+ *   -s   only the records at or after this simulation time, in seconds
+ *   -e   only the records at or before this simulation time, in seconds
+ *   -p   significant digits of the values ( default: 14, as output-vector-precision )
+ *
+ * The .vec file ( default: stdout ) has the version 2 layout. The selection uses the index: only the
+ * blocks of the selected vectors that overlap the time range are decompressed.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <unistd.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "ColumnarVector.h"
+
+// Exact decimal form of a raw simulation time, as SimTime::str(): trailing zeros are dropped.
+
+static std::string formatTime(int64_t raw, int scale_exponent) {
+
+    int64_t scale = 1;
+    for (int d = 0; d < -scale_exponent; d++)
+        scale *= 10;
+
+    uint64_t magnitude = raw < 0 ? -(uint64_t) raw : raw;
+    char text[64];
+    int length = snprintf(text, sizeof(text), "%s%llu", raw < 0 ? "-" : "", (unsigned long long) (magnitude / scale));
+
+    uint64_t fraction = magnitude % scale;
+    if (fraction > 0) {
+        length += snprintf(text + length, sizeof(text) - length, ".%0*llu", -scale_exponent, (unsigned long long) fraction);
+        while (text[length - 1] == '0')
+            text[--length] = 0;
+    }
+
+    return text;
+}
+
+// Module paths, names and attribute values are quoted when they contain spaces or quotes.
+
+static std::string quote(const std::string& text) {
+
+    if (!text.empty() && text.find_first_of(" \t\"\\") == std::string::npos)
+        return text;
+
+    std::string quoted = "\"";
+    for (size_t c = 0; c < text.size(); c++) {
+        if (text[c] == '"' || text[c] == '\\')
+            quoted += '\\';
+        quoted += text[c];
+    }
+
+    return quoted + "\"";
+}
+
+static void usage(const char *program) {
+
+    fprintf(stderr, "Usage: %s [-l] [-m module] [-n name] [-s start] [-e end] [-p precision] <.vecc file> [.vec file]\n", program);
+    exit(1);
+}
+
+int main(int argc, char *argv[]) {
+
+    bool list = false;
+    const char *module_filter = "";
+    const char *name_filter = "";
+    double start = -INFINITY;
+    double end = INFINITY;
+    int precision = 14;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "lm:n:s:e:p:")) != -1) {
+        switch (opt) {
+            case 'l': list = true; break;
+            case 'm': module_filter = optarg; break;
+            case 'n': name_filter = optarg; break;
+            case 's': start = atof(optarg); break;
+            case 'e': end = atof(optarg); break;
+            case 'p': precision = atoi(optarg); break;
+            default:
+                usage(argv[0]);
+        }
+    }
+
+    if (optind != argc - 1 && optind != argc - 2)
+        usage(argv[0]);
+
+    ColumnarVectorReader reader;
+
+    if (!reader.open(argv[optind])) {
+        fprintf(stderr, "%s: cannot read the columnar vector file %s\n", argv[0], argv[optind]);
+        return 1;
+    }
+
+    // Time range in raw ticks: the bounds beyond the int64 range are left open.
+    double ticks_per_second = pow(10.0, -reader.scale_exponent);
+    int64_t start_raw = start * ticks_per_second > -9.2e18 ? (int64_t) ceil(start * ticks_per_second) : INT64_MIN;
+    int64_t end_raw = end * ticks_per_second < 9.2e18 ? (int64_t) floor(end * ticks_per_second) : INT64_MAX;
+
+    std::map<uint32_t, bool> selected;
+    for (std::map<uint32_t, ColumnarVectorInfo>::iterator it = reader.vectors.begin(); it != reader.vectors.end(); ++it)
+        selected[it->first] = strstr(it->second.module.c_str(), module_filter) && strstr(it->second.name.c_str(), name_filter);
+
+    if (list) {
+
+        // Records and time range of each vector, from the index alone.
+        struct Summary { uint64_t count; int64_t first; int64_t last; };
+        std::map<uint32_t, Summary> summaries;
+
+        for (size_t b = 0; b < reader.blocks.size(); b++) {
+            const ColumnarBlockInfo& block = reader.blocks[b];
+            std::map<uint32_t, Summary>::iterator it = summaries.find(block.vector_id);
+            if (it == summaries.end())
+                summaries[block.vector_id] = { block.count, block.first_time, block.last_time };
+            else {
+                it->second.count += block.count;
+                it->second.last = block.last_time;
+            }
+        }
+
+        printf("id,module,name,records,first time,last time\n");
+        for (std::map<uint32_t, ColumnarVectorInfo>::iterator it = reader.vectors.begin(); it != reader.vectors.end(); ++it) {
+            if (!selected[it->first])
+                continue;
+            Summary summary = summaries.count(it->first) ? summaries[it->first] : Summary { 0, 0, 0 };
+            printf("%u,%s,%s,%llu,%s,%s\n", it->first, it->second.module.c_str(), it->second.name.c_str(),
+                    (unsigned long long) summary.count, formatTime(summary.first, reader.scale_exponent).c_str(),
+                    formatTime(summary.last, reader.scale_exponent).c_str());
+        }
+
+        return 0;
+    }
+
+    FILE *out = stdout;
+    if (optind == argc - 2 && !(out = fopen(argv[optind + 1], "w"))) {
+        fprintf(stderr, "%s: cannot create %s\n", argv[0], argv[optind + 1]);
+        return 1;
+    }
+
+    fprintf(out, "version 2\nrun %s\n\n", reader.run.c_str());
+
+    for (std::map<uint32_t, ColumnarVectorInfo>::iterator it = reader.vectors.begin(); it != reader.vectors.end(); ++it) {
+
+        if (!selected[it->first])
+            continue;
+
+        const ColumnarVectorInfo& vector = it->second;
+        fprintf(out, "vector %u  %s  %s  ETV\n", vector.id, quote(vector.module).c_str(), quote(vector.name).c_str());
+        for (size_t a = 0; a < vector.attributes.size(); a++)
+            fprintf(out, "attr %s  %s\n", vector.attributes[a].first.c_str(), quote(vector.attributes[a].second).c_str());
+    }
+
+    // The blocks are in file order: the records of every vector stay in time order.
+    ColumnarRecords records;
+
+    for (size_t b = 0; b < reader.blocks.size(); b++) {
+
+        const ColumnarBlockInfo& block = reader.blocks[b];
+
+        if (!selected[block.vector_id] || block.last_time < start_raw || block.first_time > end_raw)
+            continue;
+
+        if (!reader.readBlock(block, records)) {
+            fprintf(stderr, "%s: corrupted block at offset %llu\n", argv[0], (unsigned long long) block.offset);
+            return 1;
+        }
+
+        for (size_t r = 0; r < records.size(); r++) {
+            if (records.times[r] < start_raw || records.times[r] > end_raw)
+                continue;
+            fprintf(out, "%u\t%lld\t%s\t%.*g\n", block.vector_id, (long long) records.events[r],
+                    formatTime(records.times[r], reader.scale_exponent).c_str(), precision, records.values[r]);
+        }
+    }
+
+    if (out != stdout && fclose(out) != 0) {
+        fprintf(stderr, "%s: cannot write %s\n", argv[0], argv[optind + 1]);
+        return 1;
+    }
+
+    return 0;
+}